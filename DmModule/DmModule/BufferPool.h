@@ -0,0 +1,120 @@
+/**
+ * @file DmModule/BufferPool.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_BUFFERPOOL_H
+#define _DMMODULE_BUFFERPOOL_H
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace DmModule {
+
+/**
+ * @class BufferPool
+ * @brief Thread safe pool of reusable buffers, looked up by a key such as their shape
+ *
+ * A buffer is leased to one thread at a time and goes back to the pool when its
+ * lease is destroyed, so that the next lease with the same key reuses it instead
+ * of allocating it again. The pool must outlive its leases.
+ */
+template <typename Key, typename T>
+class BufferPool {
+
+public:
+
+  /**
+   * @brief Returns a leased buffer to its pool
+   */
+  class Release {
+  public:
+    Release(): m_pool(nullptr), m_key() { }
+    Release(BufferPool* pool, const Key& key): m_pool(pool), m_key(key) { }
+    void operator()(T* buffer) const { m_pool->release(m_key, buffer); }
+  private:
+    BufferPool* m_pool;
+    Key m_key;
+  };
+
+  /**
+   * @brief Buffer leased from the pool
+   */
+  typedef std::unique_ptr<T, Release> Lease;
+
+  BufferPool(): m_nbBuffers(0) { }
+
+  BufferPool(const BufferPool&) = delete;
+  BufferPool& operator=(const BufferPool&) = delete;
+
+  /**
+   * @brief    Lease a buffer
+   * @param    <key> key of the buffer
+   * @param    <make> callable returning a std::unique_ptr<T> to a new buffer, called
+   *           when no buffer with the key is free
+   * @return   lease of the buffer, the buffer is not cleared
+   */
+  template <typename Make>
+  Lease acquire(const Key& key, Make make) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_free.find(key);
+      if (it != m_free.end()) {
+        Lease lease(it->second.release(), Release(this, key));
+        m_free.erase(it);
+        return lease;
+      }
+    }
+    Lease lease(make().release(), Release(this, key));
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_nbBuffers;
+    return lease;
+  }
+
+  /**
+   * @brief   function to return the number of buffers allocated by the pool
+   * @return  number of buffers, leased or free
+   */
+  std::size_t getNbBuffers() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_nbBuffers;
+  }
+
+private:
+
+  void release(const Key& key, T* buffer) {
+    std::unique_ptr<T> owned(buffer);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_free.emplace(key, std::move(owned));
+  }
+
+  std::multimap<Key, std::unique_ptr<T>> m_free;
+  std::size_t m_nbBuffers;
+  mutable std::mutex m_mutex;
+
+};  // End of BufferPool class
+
+}  // namespace DmModule
+
+
+#endif
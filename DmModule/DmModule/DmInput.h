@@ -49,6 +49,17 @@ class DmInput {
 
 public:
 
+  /**
+   * @brief    Constructor
+   * @param    <catalog_file> FITS catalog file name, moved into the object
+   */
+  explicit DmInput(boost::filesystem::path catalog_file);
+
+  DmInput(const DmInput&) = default;
+  DmInput(DmInput&&) = default;
+  DmInput& operator=(const DmInput&) = default;
+  DmInput& operator=(DmInput&&) = default;
+
   /**
    * @brief Destructor
    */
@@ -63,14 +74,12 @@ public:
 
  /**
   * @brief     gets Catalog Filename in Fits format
-  * @return    <filesystem::path> Catalog File name
+  * @return    <filesystem::path> Catalog File name (reference to the internal storage)
  */
-  boost::filesystem::path getFitsCatalogFilename() const;
+  const boost::filesystem::path& getFitsCatalogFilename() const;
 
 private:
 
-  DmInput(const boost::filesystem::path& catalog_file);
-
   boost::filesystem::path m_catalog_file;
 
 };  // End of DmInput class
@@ -37,11 +37,13 @@
 //==============================================================================================
 // Tip: You can just uncomment the line below
 //==============================================================================================
-//#include "ST_DataModelBindings/dpd/le3/wl/twodmass/out/euc-test-le3-wl-twodmass-ConvergencePatch.h"
+#include "ST_DataModelBindings/dpd/le3/wl/twodmass/out/euc-test-le3-wl-twodmass-ConvergencePatch.h"
 #include "ST_DM_HeaderProvider/GenericHeaderProvider.h"
 
 namespace DmModule {
 
+class OutputPublisher;
+
 /**
  * @class DmOutput
  * @brief
@@ -58,11 +60,40 @@ public:
 
   static Euclid::DataModel::GenericHeaderGenerator* GetGenericHeader();
 
+  /**
+   * @brief    Write the output XML product pointing to the convergence maps
+   * @param    <out_xml_filename> XML product file to create
+   * @param    <fits_out_filename> FITS file of the maps, only its file name is recorded. The
+   *           data container has no field for the compression: a tile compressed file is
+   *           known by its ".fz" suffix and the ZCMPTYPE keywords of its extensions
+   * @param    <nbResamples> number of noise realizations recorded in NResamples, when it is
+   *           not 0 the FITS file holds the convergence maps followed by the mean maps and
+   *           the variance maps of the realizations
+   * @param    <exitStatusCode> ExitStatusCode of the generic header, "OK" or "ERROR" when the
+   *           maps could not be made
+   */
+  static void createOutputXml(const boost::filesystem::path& out_xml_filename,
+      const boost::filesystem::path& fits_out_filename, int nbResamples = 0,
+      const std::string& exitStatusCode = "OK");
+
+  /**
+   * @brief    Submit the output XML product to a publisher, see createOutputXml above
+   * @details  the product is published in the next group commit of the publisher,
+   *           errors are reported by OutputPublisher::flush
+   * @param    <publisher> publisher writing the product
+   */
   static void createOutputXml(const boost::filesystem::path& out_xml_filename,
-      const boost::filesystem::path& fits_out_filename);
+      const boost::filesystem::path& fits_out_filename, OutputPublisher& publisher, int nbResamples = 0);
 
 private:
 
+  /**
+   * @brief    XML of the output product written by createOutputXml, see above
+   * @return   content of the product file
+   */
+  static std::string createProduct(const boost::filesystem::path& fits_out_filename, int nbResamples = 0,
+                                   const std::string& exitStatusCode = "OK");
+
 };  // End of DmOutput class
 
 }  // namespace DmModule
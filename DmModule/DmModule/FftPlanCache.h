@@ -0,0 +1,138 @@
+/**
+ * @file DmModule/FftPlanCache.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_FFTPLANCACHE_H
+#define _DMMODULE_FFTPLANCACHE_H
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <boost/filesystem.hpp>
+#include <fftw3.h>
+
+namespace DmModule {
+
+/**
+ * @class FftPlanCache
+ * @brief Process wide cache of the in-place complex 2D FFT plans
+ *
+ * A plan is made once per grid shape and batch size, on a scratch buffer, and
+ * shared by all the threads: the plans are executed with fftw_execute_dft on
+ * buffers allocated with fftw_malloc, which is thread safe. The planner itself
+ * is serialized by the cache. The wisdom gathered by the planner can be saved
+ * to a file and loaded by the next runs, so that measured plans are only
+ * measured once.
+ */
+class FftPlanCache {
+
+public:
+
+  /**
+   * @brief Planner effort, the FFTW planner flags
+   */
+  enum class Effort {
+    ESTIMATE,   ///< heuristic plans, made instantly
+    MEASURE,    ///< plans timed on the machine, worth it with a wisdom file
+    PATIENT     ///< wider search than MEASURE
+  };
+
+  /**
+   * @brief Forward and backward plans of a grid shape
+   */
+  struct Plans {
+    fftw_plan forward, backward;
+  };
+
+  /**
+   * @brief   function to return the cache of the process
+   * @return  the cache
+   */
+  static FftPlanCache& getInstance();
+
+  /**
+   * @brief    Planner effort from its name
+   * @param    <name> estimate, measure or patient
+   * @return   effort
+   */
+  static Effort parseEffort(const std::string& name);
+
+  /**
+   * @brief Destructor, destroys the plans
+   */
+  virtual ~FftPlanCache();
+
+  FftPlanCache(const FftPlanCache&) = delete;
+  FftPlanCache& operator=(const FftPlanCache&) = delete;
+
+  /**
+   * @brief    Plans of a batch of grids, made on the first call
+   * @details  the grids of a batch are contiguous, xdim * ydim complex pixels each,
+   *           and are transformed in place
+   * @param    <xdim> number of pixels along X-axis of a grid
+   * @param    <ydim> number of pixels along Y-axis of a grid
+   * @param    <batch> number of grids transformed by one execution
+   * @return   plans, valid for the lifetime of the cache
+   */
+  Plans getPlans(std::size_t xdim, std::size_t ydim, std::size_t batch = 1);
+
+  /**
+   * @brief    Set the effort of the plans made from now on
+   * @param    <effort> planner effort
+   */
+  void setEffort(Effort effort);
+
+  /**
+   * @brief    Load the wisdom of a previous run
+   * @param    <filename> wisdom file
+   * @return   false if the file does not exist or cannot be read
+   */
+  bool importWisdom(const boost::filesystem::path& filename);
+
+  /**
+   * @brief    Save the wisdom of the planner, the file is replaced atomically
+   * @param    <filename> wisdom file
+   */
+  void exportWisdom(const boost::filesystem::path& filename);
+
+  /**
+   * @brief   function to return the number of plans made
+   * @return  number of grid shapes and batch sizes planned
+   */
+  std::size_t size() const;
+
+private:
+
+  FftPlanCache();
+
+  unsigned m_flags;
+  std::map<std::tuple<std::size_t, std::size_t, std::size_t>, Plans> m_plans;
+  mutable std::mutex m_mutex;
+
+};  // End of FftPlanCache class
+
+}  // namespace DmModule
+
+
+#endif
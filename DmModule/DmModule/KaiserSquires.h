@@ -0,0 +1,147 @@
+/**
+ * @file DmModule/KaiserSquires.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_KAISERSQUIRES_H
+#define _DMMODULE_KAISERSQUIRES_H
+
+#include <cstddef>
+#include <vector>
+#include <fftw3.h>
+
+#include "DmModule/FftPlanCache.h"
+#include "DmModule/PatchMap.h"
+
+namespace DmModule {
+
+/**
+ * @class KaiserSquires
+ * @brief Kaiser-Squires inversion between shear and convergence maps
+ *
+ * The transforms are done with FFTW on maps of a fixed size. When borders are
+ * added, the maps are zero padded to twice their size before the FFT to reduce
+ * the periodic boundary effects, and cropped back afterwards. The plans come
+ * from the FftPlanCache, so every instance working on the same grid shares
+ * them; several maps are transformed together, in batches of up to batchSize
+ * grids, by a single execution of the plans.
+ */
+class KaiserSquires {
+
+public:
+
+  /**
+   * @brief    Constructor, allocates the FFT buffer of a batch
+   * @param    <xdim> number of pixels along X-axis of the maps
+   * @param    <ydim> number of pixels along Y-axis of the maps
+   * @param    <addBorders> true to zero pad the maps before the FFT
+   * @param    <batchSize> largest number of maps transformed together
+   */
+  KaiserSquires(std::size_t xdim, std::size_t ydim, bool addBorders = false, std::size_t batchSize = 1);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~KaiserSquires();
+
+  KaiserSquires(const KaiserSquires&) = delete;
+  KaiserSquires& operator=(const KaiserSquires&) = delete;
+
+  std::size_t getBatchSize() const { return m_batchSize; }
+
+  /**
+   * @brief    Shear to convergence inversion
+   * @param    <gamma1> first shear component, xdim * ydim pixels
+   * @param    <gamma2> second shear component
+   * @param    <kappaE> output E-mode convergence
+   * @param    <kappaB> output B-mode convergence
+   */
+  void shearToConvergence(const double* gamma1, const double* gamma2, double* kappaE, double* kappaB);
+
+  /**
+   * @brief    Convergence to shear, inverse of shearToConvergence
+   * @param    <kappaE> E-mode convergence, xdim * ydim pixels
+   * @param    <kappaB> B-mode convergence
+   * @param    <gamma1> output first shear component
+   * @param    <gamma2> output second shear component
+   */
+  void convergenceToShear(const double* kappaE, const double* kappaB, double* gamma1, double* gamma2);
+
+  /**
+   * @brief    Shear to convergence inversion of several maps, transformed in batches
+   * @param    <count> number of maps
+   * @param    <gamma1> first shear component of each map
+   * @param    <gamma2> second shear component of each map
+   * @param    <kappaE> output E-mode convergence of each map
+   * @param    <kappaB> output B-mode convergence of each map
+   */
+  void shearToConvergence(std::size_t count, const double* const* gamma1, const double* const* gamma2,
+                          double* const* kappaE, double* const* kappaB);
+
+  /**
+   * @brief    Convergence to shear of several maps, transformed in batches
+   * @param    <count> number of maps
+   * @param    <kappaE> E-mode convergence of each map
+   * @param    <kappaB> B-mode convergence of each map
+   * @param    <gamma1> output first shear component of each map
+   * @param    <gamma2> output second shear component of each map
+   */
+  void convergenceToShear(std::size_t count, const double* const* kappaE, const double* const* kappaB,
+                          double* const* gamma1, double* const* gamma2);
+
+  /**
+   * @brief    Shear to convergence inversion of a shear map
+   * @param    <shearMap> shear map, layers gamma1 and gamma2 are used
+   * @return   convergence map with the E-mode and B-mode layers
+   */
+  PatchMap shearToConvergence(const PatchMap& shearMap);
+
+  /**
+   * @brief    Shear to convergence inversion of shear maps, transformed in batches
+   * @param    <shearMaps> shear maps, layers gamma1 and gamma2 are used
+   * @return   convergence maps with the E-mode and B-mode layers
+   */
+  std::vector<PatchMap> shearToConvergence(const std::vector<PatchMap>& shearMaps);
+
+private:
+
+  typedef void (KaiserSquires::*Transform)(std::size_t, const double* const*, const double* const*,
+                                            double* const*, double* const*, bool);
+
+  struct TransformSelector;
+
+  void checkShape(const PatchMap& map) const;
+
+  template <bool AddBorders>
+  void transform(std::size_t count, const double* const* in1, const double* const* in2, double* const* out1,
+                 double* const* out2, bool toConvergence);
+
+  std::size_t m_xdim, m_ydim, m_fftXdim, m_fftYdim, m_xoffset, m_yoffset, m_batchSize;
+  Transform m_transform;
+  fftw_complex* m_buffer;
+  FftPlanCache::Plans m_plans;
+
+};  // End of KaiserSquires class
+
+}  // namespace DmModule
+
+
+#endif
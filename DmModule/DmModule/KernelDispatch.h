@@ -0,0 +1,66 @@
+/**
+ * @file DmModule/KernelDispatch.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_KERNELDISPATCH_H
+#define _DMMODULE_KERNELDISPATCH_H
+
+namespace DmModule {
+
+/**
+ * @class KernelDispatch
+ * @brief Turns runtime flags into template arguments of a kernel
+ *
+ * A kernel is a functor with a result_type typedef and a member template
+ * run<bool...>() const. The flags are tested once, when the kernel is
+ * dispatched, and the selected instantiation runs without testing them again.
+ */
+template <typename Kernel, bool... Bound>
+struct KernelDispatch {
+
+  static typename Kernel::result_type call(const Kernel& kernel) {
+    return kernel.template run<Bound...>();
+  }
+
+  template <typename... Flags>
+  static typename Kernel::result_type call(const Kernel& kernel, bool flag, Flags... flags) {
+    return flag ? KernelDispatch<Kernel, Bound..., true>::call(kernel, flags...)
+                : KernelDispatch<Kernel, Bound..., false>::call(kernel, flags...);
+  }
+
+};  // End of KernelDispatch struct
+
+/**
+ * @brief    Run the instantiation of the kernel matching the flags
+ * @param    <kernel> functor with a member template run<bool...>() const
+ * @param    <flags> runtime flags, in the order of the template arguments of run
+ * @return   result of the kernel
+ */
+template <typename Kernel, typename... Flags>
+typename Kernel::result_type dispatchKernel(const Kernel& kernel, Flags... flags) {
+  return KernelDispatch<Kernel>::call(kernel, static_cast<bool>(flags)...);
+}
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file DmModule/MapMaker.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_MAPMAKER_H
+#define _DMMODULE_MAPMAKER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "DmModule/Parameters.h"
+#include "DmModule/PatchMap.h"
+#include "DmModule/ShearCatalog.h"
+
+namespace DmModule {
+
+/**
+ * @class MapMaker
+ * @brief Bins a shear catalog into Cartesian shear maps, one per patch and redshift bin
+ *
+ * Galaxies are projected on the plane tangent to each patch center (gnomonic
+ * projection). The shear maps have three layers: the weighted mean of gamma1,
+ * the weighted mean of gamma2 and the number of galaxies in the pixel.
+ */
+class MapMaker {
+
+public:
+
+  /**
+   * @brief    Constructor from the processing parameters
+   * @param    <param> Parameters giving the patches geometry and the redshift bins
+   */
+  explicit MapMaker(Parameters& param);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~MapMaker() = default;
+
+  /**
+   * @brief    Bin the catalog
+   * @param    <catalog> shear catalog
+   * @return   shear maps, map of patch p and redshift bin z at index p * nbZBins + z
+   */
+  std::vector<PatchMap> makeShearMaps(const ShearCatalog& catalog) const;
+
+  /**
+   * @brief Pixels of the shear maps the galaxies of a catalog fall in
+   *
+   * The catalog can be binned again from the footprint with other shear values,
+   * e.g. noise realizations, without projecting the galaxies again.
+   */
+  struct Footprint {
+    std::vector<std::size_t> galaxies;  ///< galaxy of each entry, one entry per map the galaxy falls in
+    std::vector<std::size_t> pixels;    ///< index of the map times the number of pixels of a map, plus the pixel
+    std::vector<PatchMap> maps;         ///< shear maps with the number of galaxies of the pixels and no shear
+  };
+
+  /**
+   * @brief    Locate the galaxies of the catalog in the pixels of the maps
+   * @param    <catalog> shear catalog
+   * @return   footprint of the catalog, the entries are in the order they are binned by makeShearMaps
+   */
+  Footprint makeFootprint(const ShearCatalog& catalog) const;
+
+  /**
+   * @brief   function to return the number of pixels on a side of the maps
+   * @return  number of pixels
+   */
+  std::size_t getNbPixels() const { return m_nbPixels; }
+
+  /**
+   * @brief   function to return the lower edges of the redshift bins followed by zMax
+   * @return  nbZBins + 1 edges
+   */
+  const std::vector<double>& getZEdges() const { return m_zEdges; }
+
+private:
+
+  template <typename Visitor>
+  struct LocateKernel;
+
+  std::vector<int> balanceBins(const ShearCatalog& catalog) const;
+
+  std::vector<PatchMap> makeMaps() const;
+
+  template <bool BalancedBins, typename Visitor>
+  void locateGalaxies(const ShearCatalog& catalog, const std::vector<int>& balancedBin, Visitor& visit) const;
+
+  std::size_t m_nbPixels;
+  double m_pixelSize;
+  std::vector<double> m_centerX, m_centerY;
+  std::vector<double> m_zEdges;
+  bool m_balancedBins;
+
+};  // End of MapMaker class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file DmModule/MassMapping.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_MASSMAPPING_H
+#define _DMMODULE_MASSMAPPING_H
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "DmModule/BufferPool.h"
+#include "DmModule/KaiserSquires.h"
+#include "DmModule/Parameters.h"
+#include "DmModule/PatchMap.h"
+#include "DmModule/Starlet.h"
+
+namespace DmModule {
+
+/**
+ * @class MassMapping
+ * @brief Reconstruction of a convergence map from a binned shear map
+ *
+ * The chain follows the 2D-MASS-WL processing:
+ *  - Kaiser-Squires inversion, with sparse inpainting of the empty pixels when NInpaint > 0,
+ *  - reduced shear correction iterated NItReducedShear times, the convergence being
+ *    denoised with RSsigmaGauss and RSthresholdFDR between the iterations,
+ *  - final denoising with a gaussian filter of width sigmaGauss (in pixels) and an
+ *    FDR thresholding in wavelet space at rate thresholdFDR.
+ *
+ * The ForceBMode and EqualVarPerScale flags select a specialization of the
+ * reconstruction once per map (see ReconstructionKernels.h). The patches of a
+ * product are reconstructed in lockstep, up to batchSize at a time, so that
+ * their Kaiser-Squires transforms run as batches of FFTs.
+ *
+ * With a convergence tolerance, a patch stops its inpainting, or its reduced
+ * shear correction, as soon as an iteration changes its E-mode convergence by
+ * less than the tolerance (relative L2 norm). The gaps of a patch are then
+ * first filled from a previous solution: its previous reduced shear pass, or
+ * the solution of the previous redshift bin of the same patch.
+ *
+ * The Kaiser-Squires transforms and their FFT buffers are kept in a pool shared
+ * by the copies of the MassMapping, and reused by the next reconstructions of
+ * maps of the same size, including the concurrent ones.
+ */
+class MassMapping {
+
+public:
+
+  /**
+   * @brief Largest number of patches reconstructed together
+   */
+  static const std::size_t batchSize = 8;
+
+  /**
+   * @brief Iterations run for a patch
+   */
+  struct Iterations {
+    int inpainting;     ///< inpainting iterations, summed over the reduced shear passes
+    int reducedShear;   ///< reduced shear corrections, at most NItReducedShear
+  };
+
+  /**
+   * @brief    Constructor from the processing parameters
+   * @param    <param> Parameters of the reconstruction
+   */
+  explicit MassMapping(Parameters& param);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~MassMapping() = default;
+
+  /**
+   * @brief    Reconstruct the convergence
+   * @param    <shearMap> shear map made by the MapMaker
+   * @param    <iterations> filled with the iterations run, when given
+   * @return   convergence map with the E-mode and B-mode layers
+   */
+  PatchMap reconstruct(const PatchMap& shearMap, Iterations* iterations = nullptr) const;
+
+  /**
+   * @brief    Reconstruct the convergence of several patches
+   * @details  consecutive maps of the same size are reconstructed together
+   * @param    <shearMaps> shear maps, map of patch p and redshift bin z at index p * nbZBins + z
+   *           as made by the MapMaker
+   * @param    <iterations> filled with the iterations run for each map, when given
+   * @param    <nbZBins> number of redshift bins of each patch, 1 for independent maps
+   * @return   convergence maps with the E-mode and B-mode layers
+   */
+  std::vector<PatchMap> reconstruct(const std::vector<PatchMap>& shearMaps,
+                                    std::vector<Iterations>* iterations = nullptr, std::size_t nbZBins = 1) const;
+
+private:
+
+  struct ReconstructKernel;
+
+  struct Patch;
+
+  template <bool ForceBMode, bool EqualVarPerScale>
+  std::vector<PatchMap> reconstructWith(const std::vector<const PatchMap*>& shearMaps,
+                                        const std::vector<PatchMap>& warmStarts, std::vector<PatchMap>& solutions,
+                                        std::vector<Iterations>& iterations) const;
+
+  template <bool ForceBMode, bool EqualVarPerScale>
+  void inpaint(KaiserSquires& ks, const Starlet& starlet, std::vector<Patch*>& patches) const;
+
+  void denoise(const Starlet& starlet, double* image, std::size_t xdim, std::size_t ydim,
+               double sigma, double threshold) const;
+
+  int m_NInpaint, m_NItReducedShear, m_nbScales;
+  bool m_forceBMode, m_equalVarPerScale, m_addBorders;
+  double m_sigmaGauss, m_thresholdFDR, m_RSsigmaGauss, m_RSthresholdFDR, m_tolerance;
+  // transforms by x size, y size and batch size
+  std::shared_ptr<BufferPool<std::array<std::size_t, 3>, KaiserSquires>> m_transforms;
+
+};  // End of MassMapping class
+
+}  // namespace DmModule
+
+
+#endif
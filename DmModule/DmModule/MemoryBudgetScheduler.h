@@ -0,0 +1,179 @@
+/**
+ * @file DmModule/MemoryBudgetScheduler.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_MEMORYBUDGETSCHEDULER_H
+#define _DMMODULE_MEMORYBUDGETSCHEDULER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "DmModule/Parameters.h"
+#include "DmModule/WorkerPool.h"
+
+namespace DmModule {
+
+/**
+ * @class MemoryBudgetScheduler
+ * @brief Runs jobs concurrently while their estimated peak memory fits in a node budget
+ *
+ * Every job comes with an estimate of its peak memory, e.g. from estimatePeakMemory.
+ * The jobs go to the worker pool at once, and a worker taking a job reserves its
+ * corrected estimate only then, in submission order, while the sum of the
+ * reservations of the running jobs stays within the budget; a job larger than the
+ * budget runs alone. The resident memory of the process is sampled while jobs
+ * run, and the ratio of its growth since each job started to the estimates of the
+ * finished jobs corrects the next estimates.
+ */
+class MemoryBudgetScheduler {
+
+public:
+
+  /**
+   * @brief    Peak memory of the reconstruction of a product
+   * @details  The maps have PatchWidth / Pixelsize pixels on a side, there are nbPatches *
+   *           nbZBins of them, with their noise mean and variance when nbSamples > 0. The
+   *           working set of the reconstruction of a batch of maps (FFT buffers, wavelet
+   *           coefficients) is added, once more for every noise realization in flight (two
+   *           per worker), and the catalog columns when the job reads the catalog itself.
+   * @param    <param> Parameters of the job
+   * @param    <nbGalaxies> number of galaxies of the catalog read by the job, 0 if it is shared
+   * @param    <nbWorkers> number of workers making the noise realizations, 0 for one per core
+   * @return   estimate in bytes
+   */
+  static std::size_t estimatePeakMemory(Parameters& param, std::size_t nbGalaxies = 0, unsigned nbWorkers = 0);
+
+  /**
+   * @brief   function to return the resident memory of the process
+   * @return  resident set size in bytes, 0 when it cannot be measured
+   */
+  static std::size_t getResidentMemory();
+
+  /**
+   * @brief    Constructor
+   * @param    <budget> memory available to the jobs in bytes, 0 for 80% of the memory available now
+   * @param    <nbThreads> largest number of jobs running at the same time, 0 for one per core
+   * @param    <placement> pinning of the threads running the jobs
+   */
+  explicit MemoryBudgetScheduler(std::size_t budget = 0, unsigned nbThreads = 0,
+                                 WorkerPool::Placement placement = WorkerPool::Placement::NONE);
+
+  /**
+   * @brief Destructor, waits for the submitted jobs
+   */
+  virtual ~MemoryBudgetScheduler();
+
+  MemoryBudgetScheduler(const MemoryBudgetScheduler&) = delete;
+  MemoryBudgetScheduler& operator=(const MemoryBudgetScheduler&) = delete;
+
+  /**
+   * @brief    Queues a job until the memory it needs is available
+   * @param    <estimate> estimated peak memory of the job in bytes
+   * @param    <task> callable without arguments
+   * @return   future holding the result, or the exception thrown by the job
+   */
+  template <typename Task>
+  std::future<typename std::result_of<Task()>::type> submit(std::size_t estimate, Task task) {
+    typedef typename std::result_of<Task()>::type Result;
+    auto job = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = job->get_future();
+    enqueue(-1, estimate, [job]() { (*job)(); });
+    return result;
+  }
+
+  /**
+   * @brief    Queues a job for a node until the memory it needs is available
+   * @param    <node> index of the node running the job, see WorkerPool::submitOn
+   * @param    <estimate> estimated peak memory of the job in bytes
+   * @param    <task> callable without arguments
+   * @return   future holding the result, or the exception thrown by the job
+   */
+  template <typename Task>
+  std::future<typename std::result_of<Task()>::type> submitOn(unsigned node, std::size_t estimate, Task task) {
+    typedef typename std::result_of<Task()>::type Result;
+    auto job = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = job->get_future();
+    enqueue(static_cast<int>(node % getNbNodes()), estimate, [job]() { (*job)(); });
+    return result;
+  }
+
+  std::size_t getBudget() const { return m_budget; }
+
+  unsigned getNbNodes() const { return m_pool.getNbNodes(); }
+
+  /**
+   * @brief   function to return the factor applied to the estimates
+   * @return  ratio of the measured to the estimated memory of the finished jobs
+   */
+  double getCorrection() const;
+
+  /**
+   * @brief   function to return the largest number of jobs which ran at the same time
+   * @return  number of jobs
+   */
+  unsigned getMaxConcurrency() const;
+
+private:
+
+  struct Job {
+    int node;
+    std::size_t order, estimate;
+    double reserved, measuredRatio;
+    std::size_t startResident;
+    std::function<void()> task;
+  };
+
+  void enqueue(int node, std::size_t estimate, std::function<void()> task);
+
+  void start(std::shared_ptr<Job> job);
+
+  void run(std::shared_ptr<Job> job);
+
+  void record(std::size_t residentMemory);
+
+  void samplerLoop();
+
+  std::size_t m_budget;
+  unsigned m_nbSlots, m_running, m_maxConcurrency;
+  double m_correction, m_reserved;
+  std::size_t m_nbSubmitted, m_nbUnfinished;
+  std::deque<std::shared_ptr<Job>> m_waiting;
+  std::vector<std::shared_ptr<Job>> m_active;
+  bool m_stopping;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_idle, m_sample, m_admission;
+  WorkerPool m_pool;
+  std::thread m_sampler;
+
+};  // End of MemoryBudgetScheduler class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,135 @@
+/**
+ * @file DmModule/NoiseResampler.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_NOISERESAMPLER_H
+#define _DMMODULE_NOISERESAMPLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "DmModule/BufferPool.h"
+#include "DmModule/MapMaker.h"
+#include "DmModule/MassMapping.h"
+#include "DmModule/Parameters.h"
+#include "DmModule/PatchMap.h"
+#include "DmModule/ShearCatalog.h"
+#include "DmModule/WorkerPool.h"
+
+namespace DmModule {
+
+/**
+ * @class NoiseResampler
+ * @brief Monte Carlo noise realizations of the convergence maps of a catalog
+ *
+ * A realization rotates the shear of every galaxy by a random angle, which
+ * removes the lensing signal and keeps the shape noise, bins the rotated shear
+ * with the footprint of the catalog and reconstructs its convergence with the
+ * MassMapping of the Parameters. The angles are drawn from a counter-based
+ * generator (Philox4x32-10) keyed by the seed, whose counter is the index of the
+ * realization and of the galaxy: a realization does not depend on the thread
+ * which makes it, nor on the realizations made before it.
+ *
+ * The realizations run on a worker pool and are reduced in their order into the
+ * mean and variance maps as they come, with at most two realizations per worker
+ * in flight. The statistics are the same for any number of threads and the
+ * memory does not grow with the number of realizations. The binned shear maps
+ * come from a pool of buffers, and the MassMapping reuses its FFT buffers.
+ */
+class NoiseResampler {
+
+public:
+
+  /**
+   * @brief Statistics of the realizations, one map per shear map of the MapMaker
+   */
+  struct Statistics {
+    std::vector<PatchMap> mean;       ///< mean of the E-mode and B-mode convergence
+    std::vector<PatchMap> variance;   ///< unbiased variance of the E-mode and B-mode convergence
+    int nbRealizations;               ///< number of realizations reduced
+  };
+
+  /**
+   * @brief    Constructor, locates the galaxies of the catalog in the maps
+   * @param    <param> Parameters of the binning and of the reconstruction
+   * @param    <catalog> shear catalog, it must outlive the resampler
+   * @param    <seed> key of the random streams
+   */
+  NoiseResampler(Parameters& param, const ShearCatalog& catalog, std::uint64_t seed = 0);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~NoiseResampler() = default;
+
+  NoiseResampler(const NoiseResampler&) = delete;
+  NoiseResampler& operator=(const NoiseResampler&) = delete;
+
+  /**
+   * @brief    Make one realization
+   * @param    <index> index of the realization
+   * @return   convergence maps of the realization, map of patch p and redshift bin z at
+   *           index p * nbZBins + z
+   */
+  std::vector<PatchMap> makeRealization(std::uint64_t index) const;
+
+  /**
+   * @brief    Make the nbSamples realizations of the Parameters and reduce them
+   * @param    <pool> workers making the realizations
+   * @return   mean and variance maps
+   */
+  Statistics resample(WorkerPool& pool) const;
+
+  /**
+   * @brief    Make realizations 0 to nbRealizations - 1 and reduce them
+   * @param    <nbRealizations> number of realizations
+   * @param    <pool> workers making the realizations
+   * @return   mean and variance maps
+   */
+  Statistics resample(int nbRealizations, WorkerPool& pool) const;
+
+  /**
+   * @brief   function to return the number of shear map buffers allocated
+   * @return  number of buffers, at most the number of realizations made at the same time
+   */
+  std::size_t getNbBuffers() const { return m_buffers.getNbBuffers(); }
+
+private:
+
+  void binRealization(std::uint64_t index, std::vector<PatchMap>& shearMaps) const;
+
+  const ShearCatalog& m_catalog;
+  MassMapping m_massMapping;
+  MapMaker::Footprint m_footprint;
+  std::size_t m_nbZBins;
+  std::vector<double> m_weightSums;
+  std::uint64_t m_seed;
+  int m_nbSamples;
+  mutable BufferPool<int, std::vector<PatchMap>> m_buffers;
+
+};  // End of NoiseResampler class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,120 @@
+/**
+ * @file DmModule/OutputCompressor.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_OUTPUTCOMPRESSOR_H
+#define _DMMODULE_OUTPUTCOMPRESSOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "DmModule/PatchMap.h"
+#include "DmModule/WorkerPool.h"
+
+namespace DmModule {
+
+/**
+ * @class OutputCompressor
+ * @brief Compressed writing of the output maps
+ *
+ * The maps are tile compressed in FITS files with the ".fz" suffix, one tile
+ * per layer: RICE_1 quantizes the pixel values (lossy), GZIP_2 is lossless.
+ * The LOSSY keyword of every compressed extension records which. The work
+ * is spread over a pool of threads: every map (or image extension) is
+ * compressed in memory by one thread and the file is assembled from the
+ * compressed extensions.
+ */
+class OutputCompressor {
+
+public:
+
+  enum class Format { NONE, RICE, GZIP };
+
+  /**
+   * @brief    Format from its option value
+   * @param    <name> "none", "rice" or "gzip"
+   * @return   compression format
+   */
+  static Format parseFormat(const std::string& name);
+
+  /**
+   * @brief    Constructor
+   * @param    <format> compression of the outputs, NONE to write them as they are
+   * @param    <nbThreads> number of compression threads, 0 for one per core
+   */
+  explicit OutputCompressor(Format format = Format::NONE, unsigned nbThreads = 0);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~OutputCompressor() = default;
+
+  Format getFormat() const { return m_format; }
+
+  /**
+   * @brief   function to return the CFITSIO tile compression of the maps
+   * @return  "NONE", "RICE_1" or "GZIP_2"
+   */
+  std::string getMapFormat() const;
+
+  /**
+   * @brief    Name of the FITS file of the maps
+   * @param    <filename> FITS file name
+   * @return   filename, with ".fz" appended when the maps are compressed
+   */
+  boost::filesystem::path getMapFilename(const boost::filesystem::path& filename) const;
+
+  /**
+   * @brief    Write the maps in a FITS file given by its exact name, compressed with the format
+   * @param    <output> file to create
+   * @param    <maps> maps to write
+   */
+  void writeMapFile(const boost::filesystem::path& output, const std::vector<PatchMap>& maps);
+
+  /**
+   * @brief    Write the maps in a FITS file, one image extension per map
+   * @param    <filename> FITS file name, ".fz" is appended when the maps are compressed
+   * @param    <maps> maps to write
+   * @return   name of the written file
+   */
+  boost::filesystem::path writeMaps(const boost::filesystem::path& filename, const std::vector<PatchMap>& maps);
+
+  /**
+   * @brief    Tile compress the image extensions of an existing FITS file
+   * @param    <filename> FITS file, removed once the compressed copy is written
+   * @return   name of the compressed file, filename itself when the format is NONE
+   */
+  boost::filesystem::path compressFits(const boost::filesystem::path& filename);
+
+private:
+
+  Format m_format;
+  WorkerPool m_pool;
+
+};  // End of OutputCompressor class
+
+}  // namespace DmModule
+
+
+#endif
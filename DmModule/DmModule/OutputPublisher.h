@@ -0,0 +1,145 @@
+/**
+ * @file DmModule/OutputPublisher.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_OUTPUTPUBLISHER_H
+#define _DMMODULE_OUTPUTPUBLISHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "DmModule/WorkerPool.h"
+
+namespace DmModule {
+
+/**
+ * @class OutputPublisher
+ * @brief Publishes output files with group commits
+ *
+ * The outputs are written in parallel to hidden staging files next to their
+ * final name. The staged outputs are collected and committed in groups: the
+ * files of a group are synced concurrently, renamed to their final names in
+ * submission order and the directories are synced once per group. A group is
+ * committed when it holds maxBatch outputs or when its oldest output has waited
+ * maxLatency. As the rename is atomic, readers see either no file or the
+ * complete one.
+ */
+class OutputPublisher {
+
+public:
+
+  /**
+   * @brief    Constructor, starts the writers and the committer thread
+   * @param    <nbThreads> number of writer threads, 0 for one per core
+   * @param    <maxLatency> longest time an output waits for its group to be committed
+   * @param    <maxBatch> largest number of outputs in a group
+   */
+  explicit OutputPublisher(unsigned nbThreads = 0,
+                           std::chrono::milliseconds maxLatency = std::chrono::milliseconds(100),
+                           std::size_t maxBatch = 64);
+
+  /**
+   * @brief Destructor, publishes the pending outputs
+   */
+  virtual ~OutputPublisher();
+
+  OutputPublisher(const OutputPublisher&) = delete;
+  OutputPublisher& operator=(const OutputPublisher&) = delete;
+
+  /**
+   * @brief    Staging file name of an output, hidden file in the same directory
+   * @param    <filename> final name of the output
+   * @return   unique staging file name
+   */
+  static boost::filesystem::path getStagingPath(const boost::filesystem::path& filename);
+
+  /**
+   * @brief    Write an output and publish it in the next group commit
+   * @param    <filename> final name of the output
+   * @param    <content> content of the output
+   * @return   future set once the output is published, or holding the error
+   */
+  std::future<void> publish(const boost::filesystem::path& filename, std::string content);
+
+  /**
+   * @brief    Publish a file already written to a staging file in the next group commit
+   * @param    <staged> staging file, e.g. from getStagingPath
+   * @param    <filename> final name of the output
+   * @return   future set once the output is published, or holding the error
+   */
+  std::future<void> publishFile(const boost::filesystem::path& staged, const boost::filesystem::path& filename);
+
+  /**
+   * @brief    Wait for the submitted outputs to be published
+   * @details  throws an Elements::Exception when outputs failed to be published since the last flush
+   */
+  void flush();
+
+  /**
+   * @brief   function to return the number of group commits done
+   * @return  number of group commits
+   */
+  std::size_t getNbGroupCommits() const;
+
+private:
+
+  struct Staged {
+    boost::filesystem::path staged, target;
+    std::shared_ptr<std::promise<void>> done;
+    std::chrono::steady_clock::time_point ready;
+  };
+
+  void stage(Staged output);
+
+  void fail(const std::shared_ptr<std::promise<void>>& done, const std::string& message);
+
+  void committerLoop();
+
+  void commit(std::vector<Staged>& group);
+
+  std::chrono::milliseconds m_maxLatency;
+  std::size_t m_maxBatch;
+  std::deque<Staged> m_ready;
+  std::size_t m_writing, m_nbGroupCommits;
+  unsigned m_flushing;
+  bool m_committing, m_stopping;
+  std::vector<std::string> m_errors;
+  mutable std::mutex m_mutex;
+  std::condition_variable m_cond, m_idle;
+  WorkerPool m_pool;
+  std::thread m_committer;
+
+};  // End of OutputPublisher class
+
+}  // namespace DmModule
+
+
+#endif
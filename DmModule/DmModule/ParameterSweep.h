@@ -0,0 +1,118 @@
+/**
+ * @file DmModule/ParameterSweep.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_PARAMETERSWEEP_H
+#define _DMMODULE_PARAMETERSWEEP_H
+
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+#include "DmModule/OutputCompressor.h"
+#include "DmModule/Parameters.h"
+#include "DmModule/ShearCatalog.h"
+#include "DmModule/WorkerPool.h"
+
+namespace DmModule {
+
+/**
+ * @class ParameterSweep
+ * @brief Runs the reconstruction of one catalog for a grid of Parameters variants
+ *
+ * The grid is given as "name=v1,v2,...;name=..." and the sweep covers all the
+ * combinations of the values. Only the parameters which do not change the binning
+ * of the catalog can be swept: sigmaGauss, thresholdFDR, NInpaint, nbScales and
+ * RSsigmaGauss. The catalog is binned once with the base parameters and the grid
+ * points are reconstructed concurrently, within the memory budget of the node.
+ * The grid points make no noise realizations, their nbSamples is 0.
+ */
+class ParameterSweep {
+
+public:
+
+  /**
+   * @brief    Constructor
+   * @param    <base> Parameters read from the parameter file
+   * @param    <grid> grid specification, e.g. "sigmaGauss=1,2;NInpaint=0,100"
+   */
+  ParameterSweep(Parameters& base, const std::string& grid);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~ParameterSweep() = default;
+
+  /**
+   * @brief   function to return the number of grid points
+   * @return  number of Parameters variants
+   */
+  std::size_t getNbPoints() const { return m_points.size(); }
+
+  /**
+   * @brief   function to return the Parameters of a grid point
+   * @param   <index> index of the grid point
+   * @return  Parameters variant
+   */
+  Parameters& getPoint(std::size_t index) { return m_points[index]; }
+
+  /**
+   * @brief   function to return the description of a grid point
+   * @param   <index> index of the grid point
+   * @return  the swept values, e.g. "sigmaGauss=1 NInpaint=100"
+   */
+  const std::string& getLabel(std::size_t index) const { return m_labels[index]; }
+
+  /**
+   * @brief    Bin the catalog and reconstruct every grid point
+   * @param    <catalog> shear catalog
+   * @param    <workdir> working directory, the FITS maps are written in workdir/data
+   * @param    <out_xml_file> output product name, the index of the grid point is appended to it
+   * @param    <nbThreads> number of grid points processed at the same time, 0 for one per core
+   * @param    <compression> compression of the FITS maps
+   * @param    <memoryBudget> memory available to the grid points in bytes, 0 for 80% of the
+   *           memory available, fewer grid points run at the same time when they do not fit
+   * @param    <placement> pinning of the threads, with a placement every node works on its
+   *           own copy of the shear maps and each grid point runs on one node
+   * @param    <nbOutputThreads> number of threads compressing the maps, and of threads writing
+   *           the outputs, in addition to the nbThreads reconstructing the grid points
+   * @return   output products, one per grid point
+   */
+  std::vector<boost::filesystem::path> run(const ShearCatalog& catalog, const boost::filesystem::path& workdir,
+                                           const boost::filesystem::path& out_xml_file, unsigned nbThreads = 0,
+                                           OutputCompressor::Format compression = OutputCompressor::Format::NONE,
+                                           std::size_t memoryBudget = 0,
+                                           WorkerPool::Placement placement = WorkerPool::Placement::NONE,
+                                           unsigned nbOutputThreads = 2);
+
+private:
+
+  Parameters m_base;
+  std::vector<Parameters> m_points;
+  std::vector<std::string> m_labels;
+
+};  // End of ParameterSweep class
+
+}  // namespace DmModule
+
+
+#endif
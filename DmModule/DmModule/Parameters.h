@@ -25,6 +25,7 @@
 #define _DMMODULE_PARAMETERS_H
 
 #include <string>
+#include <vector>
 #include <boost/filesystem.hpp>
 #include "ElementsKernel/Logging.h"
 
@@ -35,7 +36,7 @@
 //==============================================================================================
 // Tip: You can just uncomment the line below
 //==============================================================================================
-//#include "ST_DataModelBindings/dpd/le3/wl/twodmass/inp/euc-test-le3-wl-twodmass-ParamsConvergencePatch.h"
+#include "ST_DataModelBindings/dpd/le3/wl/twodmass/inp/euc-test-le3-wl-twodmass-ParamsConvergencePatch.h"
 
 namespace DmModule {
 
@@ -78,12 +79,20 @@ public:
    * @param    <thresholdFDR> Final denoising: Threshold for MRLens filtering
    * @param    <nbSamples> Number of samples for error calculations
    * @return   Fully allocated parameters
+   *
+   * The vectors are taken by value and moved into the object: pass temporaries or
+   * std::move them to build the Parameters without copying them.
   */
   Parameters(int NItReducedShear, int NPatches, float PixelSize, float PatchWidth, std::vector<double> mapCenterX,
           std::vector<double> mapCenterY, int nbZBins, std::vector<double> zMin, double zMax, long BalancedBins,
           int NInpaint, long EqualVarPerScale, long ForceBMode, int nbScales, long add_borders, float RSsigmaGauss,
           float sigmaGauss, int nbSamples, float RSthresholdFDR = 0.0, float thresholdFDR = 0.0);
 
+  Parameters(const Parameters&) = default;
+  Parameters(Parameters&&) = default;
+  Parameters& operator=(const Parameters&) = default;
+  Parameters& operator=(Parameters&&) = default;
+
   /**
    * @brief Destructor
    */
@@ -96,11 +105,19 @@ public:
   */
   Parameters readParameterFile (const boost::filesystem::path& parameter_file);
 
+  /**
+   * @brief   function to split a parameter file in one parameter file per patch
+   * @param   <parameter_file> input parameter filename
+   * @return  parameter files holding a single patch each, written next to the input with the
+   *          index of the patch appended to its name, none when the input holds a single patch
+  */
+  static std::vector<boost::filesystem::path> writePatchParameterFiles(const boost::filesystem::path& parameter_file);
+
   /**
    * @brief   function to return zMin value
-   * @return  Minimum Redshift (Z) value from Parameter file
+   * @return  Minimum Redshift (Z) value from Parameter file (reference to the internal storage)
   */
-  std::vector<double> getZMin();
+  const std::vector<double>& getZMin();
 
   /**
    * @brief   function to return zMax value
@@ -194,15 +211,15 @@ public:
 
   /**
    * @brief   function to return MapCenter at X-axis (Ra) from Parameter file
-   * @return  MapCenter at X-axis
+   * @return  MapCenter at X-axis (reference to the internal storage)
   */
-  std::vector<double> getMapCenterX();
+  const std::vector<double>& getMapCenterX();
 
   /**
    * @brief   function to return MapCenter at Y-axis (Dec) from Parameter file
-   * @return  MapCenter at Y-axis
+   * @return  MapCenter at Y-axis (reference to the internal storage)
   */
-  std::vector<double> getMapCenterY();
+  const std::vector<double>& getMapCenterY();
 
   /**
    * @brief   function to return number of SNR maps needed from Parameter file
@@ -216,6 +233,19 @@ public:
   */
   long get_BalancedBins();
 
+  /**
+   * @brief   function to return the convergence tolerance of the iterative reconstruction
+   * @return  relative change of the convergence under which the inpainting and reduced
+   *          shear iterations stop, 0 to always run NInpaint and NItReducedShear iterations
+  */
+  double getConvergenceTolerance();
+
+  /**
+   * @brief   function to set the convergence tolerance of the iterative reconstruction
+   * @param   <tolerance> relative change of the convergence, 0 to disable the early stopping
+  */
+  void setConvergenceTolerance(double tolerance);
+
 private:
 double m_zMax;
 float m_sigmaGauss, m_thresholdFDR, m_PatchWidth, m_PixelSize;
@@ -227,6 +257,7 @@ std::vector<double> m_zMin;
 int m_nbZBins, m_NInpaint, m_nbScales, m_NItReducedShear, m_nbPatches, m_nbSamples;
 
 long m_add_borders, m_ForceBMode, m_EqualVarPerScale, m_balancedBin;
+double m_convergenceTolerance;
 };  // End of Parameters class
 
 }  // namespace DmModule
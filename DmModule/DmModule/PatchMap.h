@@ -0,0 +1,113 @@
+/**
+ * @file DmModule/PatchMap.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_PATCHMAP_H
+#define _DMMODULE_PATCHMAP_H
+
+#include <cstddef>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include <fitsio.h>
+
+namespace DmModule {
+
+/**
+ * @class PatchMap
+ * @brief Cartesian map of a patch made of several layers of the same size
+ *
+ * Shear maps hold three layers (gamma1, gamma2, number of galaxies) and
+ * convergence maps two layers (E-mode and B-mode). Pixels of a layer are
+ * stored row by row, pixel (x, y) being at index y * xdim + x.
+ */
+class PatchMap {
+
+public:
+
+  /**
+   * @brief    Constructor of a map filled with zeros
+   * @param    <xdim> number of pixels along X-axis
+   * @param    <ydim> number of pixels along Y-axis
+   * @param    <nbLayers> number of layers
+   * @param    <pixelSize> pixel size in degrees
+   * @param    <centerX> center of the map at X-axis (Ra) in degrees
+   * @param    <centerY> center of the map at Y-axis (Dec) in degrees
+   */
+  PatchMap(std::size_t xdim, std::size_t ydim, std::size_t nbLayers, double pixelSize = 0.,
+           double centerX = 0., double centerY = 0.);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~PatchMap() = default;
+
+  std::size_t getXdim() const { return m_xdim; }
+  std::size_t getYdim() const { return m_ydim; }
+  std::size_t getNbLayers() const { return m_nbLayers; }
+  std::size_t getNbPixels() const { return m_xdim * m_ydim; }
+  double getPixelSize() const { return m_pixelSize; }
+  double getCenterX() const { return m_centerX; }
+  double getCenterY() const { return m_centerY; }
+
+  /**
+   * @brief   function to return the pixels of a layer
+   * @param   <layer> layer index
+   * @return  pointer to the first pixel of the layer
+   */
+  double* getLayer(std::size_t layer) { return m_data.data() + layer * getNbPixels(); }
+  const double* getLayer(std::size_t layer) const { return m_data.data() + layer * getNbPixels(); }
+
+  double& operator()(std::size_t layer, std::size_t x, std::size_t y) {
+    return m_data[(layer * m_ydim + y) * m_xdim + x];
+  }
+  const double& operator()(std::size_t layer, std::size_t x, std::size_t y) const {
+    return m_data[(layer * m_ydim + y) * m_xdim + x];
+  }
+
+  /**
+   * @brief   write the maps to a FITS file, one image extension per map
+   * @param   <filename> FITS file to create, overwritten if it exists
+   * @param   <maps> maps to write
+   */
+  static void writeFits(const boost::filesystem::path& filename, const std::vector<PatchMap>& maps);
+
+  /**
+   * @brief   append the map as an image extension with its WCS keywords
+   * @details the compression set on the file with fits_set_compression_type applies.
+   *          As for the CFITSIO routines, nothing is done when status is already set.
+   * @param   <fptr> FITS file open for writing
+   * @param   <status> CFITSIO status
+   */
+  void writeFitsHdu(fitsfile* fptr, int* status) const;
+
+private:
+
+  std::size_t m_xdim, m_ydim, m_nbLayers;
+  double m_pixelSize, m_centerX, m_centerY;
+  std::vector<double> m_data;
+
+};  // End of PatchMap class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,130 @@
+/**
+ * @file DmModule/ProcessExecutor.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_PROCESSEXECUTOR_H
+#define _DMMODULE_PROCESSEXECUTOR_H
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DmModule {
+
+/**
+ * @class ProcessExecutor
+ * @brief Runs external programs concurrently without blocking the caller
+ *
+ * The programs are started with posix_spawnp, without a shell, at most
+ * maxChildren at a time; the other jobs wait in submission order. Every child
+ * leads its own process group. A single thread polls the pipes of the children,
+ * reads their stdout and stderr without blocking, kills the process group of the
+ * children which exceed their timeout and reaps them. The
+ * result of a job holds its exit status and its captured output.
+ */
+class ProcessExecutor {
+
+public:
+
+  /**
+   * @brief Outcome of an external program
+   */
+  struct Result {
+    int status;              ///< exit status, -1 when terminated by a signal
+    int signal;              ///< signal which terminated the program, 0 when it exited
+    bool timedOut;           ///< killed after exceeding its timeout
+    std::string out, err;    ///< captured stdout and stderr
+    std::chrono::milliseconds duration;
+
+    bool succeeded() const { return status == 0 && !timedOut; }
+
+    /**
+     * @brief   function to describe how the program ended
+     * @return  e.g. "exit status 2", "signal 11" or "timeout"
+     */
+    std::string describe() const;
+  };
+
+  /**
+   * @brief    Constructor, starts the polling thread
+   * @param    <maxChildren> largest number of programs running at once, 0 for one per core
+   */
+  explicit ProcessExecutor(unsigned maxChildren = 0);
+
+  /**
+   * @brief Destructor, waits for the submitted programs to end
+   */
+  virtual ~ProcessExecutor();
+
+  ProcessExecutor(const ProcessExecutor&) = delete;
+  ProcessExecutor& operator=(const ProcessExecutor&) = delete;
+
+  /**
+   * @brief    Queues an external program
+   * @param    <argv> program, looked up in the PATH, followed by its arguments
+   * @param    <timeout> the program is killed after this time, no limit when zero
+   * @return   future holding the result, or an Elements::Exception when the program
+   *           cannot be started
+   */
+  std::future<Result> submit(std::vector<std::string> argv,
+                             std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+  /**
+   * @brief   function to return the number of programs running
+   * @return  number of children not reaped yet
+   */
+  std::size_t getNbRunning() const;
+
+private:
+
+  struct Job {
+    std::vector<std::string> argv;
+    std::chrono::milliseconds timeout;
+    std::shared_ptr<std::promise<Result>> done;
+  };
+
+  struct Child;
+
+  void start(Job& job, std::vector<std::unique_ptr<Child>>& children);
+
+  void pollLoop();
+
+  unsigned m_maxChildren;
+  std::deque<Job> m_pending;
+  std::size_t m_nbRunning;
+  bool m_stopping;
+  int m_wakeup[2];
+  mutable std::mutex m_mutex;
+  std::thread m_poller;
+
+};  // End of ProcessExecutor class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,169 @@
+/**
+ * @file DmModule/ProductIndex.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_PRODUCTINDEX_H
+#define _DMMODULE_PRODUCTINDEX_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace DmModule {
+
+/**
+ * @class ProductIndex
+ * @brief Index of the XML products of a working directory
+ *
+ * For every product of the working directory, the index records its type (the
+ * root element), the file names of its data containers and the size and
+ * modification time of the product and of the data files in workdir/data. The
+ * index is stored in a compact binary file of the working directory; an update
+ * only parses the products whose size or modification time changed, in parallel.
+ *
+ * A saved index takes the modification time of the working directory, so that
+ * products added, removed or renamed since are detected without a scan. The
+ * products known to change, such as the inputs and outputs of a run, are
+ * refreshed one by one.
+ */
+class ProductIndex {
+
+public:
+
+  /**
+   * @brief Data file referenced by a product
+   */
+  struct DataFile {
+    std::string name;        ///< file name in workdir/data
+    bool exists;
+    std::uint64_t size;
+    std::int64_t mtime;      ///< modification time in nanoseconds
+  };
+
+  /**
+   * @brief Product of the working directory
+   */
+  struct Product {
+    std::string file;        ///< file name in workdir
+    std::string type;
+    std::uint64_t size;
+    std::int64_t mtime;      ///< modification time in nanoseconds
+    std::vector<DataFile> dataFiles;
+  };
+
+  /**
+   * @brief    Reads the type and the data files of a product
+   * @param    <content> XML of the product
+   * @param    <product> product filled with its type and data file names
+   */
+  static void parseProduct(const std::string& content, Product& product);
+
+  /**
+   * @brief    Constructor, loads the index file when it exists
+   * @param    <workdir> working directory
+   * @param    <index_file> index file, workdir/.DmProductIndex when empty
+   */
+  explicit ProductIndex(const boost::filesystem::path& workdir, const boost::filesystem::path& index_file = "");
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~ProductIndex() = default;
+
+  /**
+   * @brief    Scans the working directory and updates the index
+   * @param    <nbThreads> number of threads parsing the products, 0 for one per core
+   * @return   number of products parsed, the others were unchanged
+   */
+  std::size_t update(unsigned nbThreads = 0);
+
+  /**
+   * @brief    Updates the entry of a single product, without scanning the working directory
+   * @param    <file> file name of the product, relative to the working directory
+   * @return   true when the product was parsed, false when it was unchanged or is gone
+   */
+  bool refresh(const boost::filesystem::path& file);
+
+  /**
+   * @brief    Tells if the index must be updated
+   * @return   true when the index file was missing or unreadable, or when products were
+   *           added, removed or renamed in the working directory since it was saved
+   */
+  bool isStale() const;
+
+  /**
+   * @brief    Writes the index file, replaced atomically
+   */
+  void save() const;
+
+  /**
+   * @brief    Product of the index
+   * @param    <file> file name of the product, relative to the working directory
+   * @return   product, nullptr if the index has no such product
+   */
+  const Product* find(const boost::filesystem::path& file) const;
+
+  /**
+   * @brief    Product of the index, which must exist
+   * @param    <file> file name of the product, relative to the working directory
+   * @param    <type> expected product type, any type when empty
+   * @return   product
+   */
+  const Product& resolve(const boost::filesystem::path& file, const std::string& type = "") const;
+
+  /**
+   * @brief    Products of a type
+   * @param    <type> product type, e.g. DpdTwoDMassConvergencePatch
+   * @return   products, sorted by file name
+   */
+  std::vector<const Product*> findByType(const std::string& type) const;
+
+  /**
+   * @brief    Products referencing a data file
+   * @param    <name> file name of the data file
+   * @return   products, sorted by file name
+   */
+  std::vector<const Product*> findByDataFile(const std::string& name) const;
+
+  std::size_t size() const { return m_products.size(); }
+
+  const boost::filesystem::path& getIndexFile() const { return m_indexFile; }
+
+private:
+
+  void load();
+
+  bool scanProduct(const std::string& file, Product& product, bool& parsed) const;
+
+  boost::filesystem::path m_workdir, m_indexFile;
+  std::map<std::string, Product> m_products;
+  // loaded from the index file or updated by a scan
+  bool m_complete;
+
+};  // End of ProductIndex class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,173 @@
+/**
+ * @file DmModule/ReconstructionKernels.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_RECONSTRUCTIONKERNELS_H
+#define _DMMODULE_RECONSTRUCTIONKERNELS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace DmModule {
+
+/**
+ * Inner loops of the reconstruction, specialized on the flags of the Parameters
+ * (ForceBMode, EqualVarPerScale, addBorders and BalancedBins). The flags are
+ * template arguments so that the loops carry no test on them; the instantiation
+ * is selected once per job with dispatchKernel.
+ */
+namespace Kernels {
+
+/**
+ * @brief    Hard thresholding of a wavelet scale during the inpainting
+ * @details  With EqualVarPerScale, the variance of the scale inside the gaps is
+ *           then set to the variance of the scale outside the gaps
+ * @param    <scale> wavelet scale, thresholded in place
+ * @param    <mask> 1 for the pixels with galaxies, 0 in the gaps
+ * @param    <nbPixels> number of pixels of the scale
+ * @param    <lambda> threshold
+ */
+template <bool EqualVarPerScale>
+void thresholdScale(double* scale, const char* mask, std::size_t nbPixels, double lambda) {
+  double sumIn = 0., sumSqIn = 0., sumOut = 0., sumSqOut = 0.;
+  std::size_t nbOut = 0;
+  for (std::size_t k = 0; k < nbPixels; ++k) {
+    double value = std::fabs(scale[k]) < lambda ? 0. : scale[k];
+    scale[k] = value;
+    if (EqualVarPerScale) {
+      double observed = mask[k];
+      sumOut += observed * value;
+      sumSqOut += observed * value * value;
+      sumIn += (1. - observed) * value;
+      sumSqIn += (1. - observed) * value * value;
+      nbOut += mask[k];
+    }
+  }
+  std::size_t nbIn = nbPixels - nbOut;
+  if (!EqualVarPerScale || nbIn == 0 || nbOut == 0) {
+    return;
+  }
+  double varIn = sumSqIn / nbIn - (sumIn / nbIn) * (sumIn / nbIn);
+  double varOut = sumSqOut / nbOut - (sumOut / nbOut) * (sumOut / nbOut);
+  if (varIn > 0.) {
+    double factor = std::sqrt(varOut / varIn);
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      scale[k] *= mask[k] ? 1. : factor;
+    }
+  }
+}
+
+/**
+ * @brief    Set the B-mode to zero in the gaps when ForceBMode is set, no-op otherwise
+ * @param    <kappaB> B-mode convergence
+ * @param    <mask> 1 for the pixels with galaxies, 0 in the gaps
+ * @param    <nbPixels> number of pixels of the map
+ */
+template <bool ForceBMode>
+void constrainBModes(double* kappaB, const char* mask, std::size_t nbPixels) {
+  if (!ForceBMode) {
+    return;
+  }
+  for (std::size_t k = 0; k < nbPixels; ++k) {
+    kappaB[k] = mask[k] ? kappaB[k] : 0.;
+  }
+}
+
+/**
+ * @brief    Copy two maps in the real and imaginary parts of a complex FFT buffer
+ * @details  With AddBorders the maps are placed at (xoffset, yoffset) in a buffer of
+ *           fftXdim pixels per row, otherwise the buffer has the size of the maps
+ * @param    <in1> map copied in the real part, xdim * ydim pixels
+ * @param    <in2> map copied in the imaginary part
+ * @param    <buffer> interleaved complex buffer
+ */
+template <bool AddBorders>
+void packGrid(const double* in1, const double* in2, double* buffer, std::size_t xdim, std::size_t ydim,
+              std::size_t fftXdim, std::size_t xoffset, std::size_t yoffset) {
+  if (AddBorders) {
+    for (std::size_t y = 0; y < ydim; ++y) {
+      double* row = buffer + 2 * ((y + yoffset) * fftXdim + xoffset);
+      for (std::size_t x = 0; x < xdim; ++x) {
+        row[2 * x] = in1[y * xdim + x];
+        row[2 * x + 1] = in2[y * xdim + x];
+      }
+    }
+  } else {
+    for (std::size_t k = 0; k < xdim * ydim; ++k) {
+      buffer[2 * k] = in1[k];
+      buffer[2 * k + 1] = in2[k];
+    }
+  }
+}
+
+/**
+ * @brief    Copy back and normalize the maps from a complex FFT buffer, inverse of packGrid
+ * @param    <buffer> interleaved complex buffer
+ * @param    <norm> normalization factor
+ * @param    <out1> map of the real part, xdim * ydim pixels
+ * @param    <out2> map of the imaginary part
+ */
+template <bool AddBorders>
+void unpackGrid(const double* buffer, double norm, double* out1, double* out2, std::size_t xdim, std::size_t ydim,
+                std::size_t fftXdim, std::size_t xoffset, std::size_t yoffset) {
+  if (AddBorders) {
+    for (std::size_t y = 0; y < ydim; ++y) {
+      const double* row = buffer + 2 * ((y + yoffset) * fftXdim + xoffset);
+      for (std::size_t x = 0; x < xdim; ++x) {
+        out1[y * xdim + x] = row[2 * x] * norm;
+        out2[y * xdim + x] = row[2 * x + 1] * norm;
+      }
+    }
+  } else {
+    for (std::size_t k = 0; k < xdim * ydim; ++k) {
+      out1[k] = buffer[2 * k] * norm;
+      out2[k] = buffer[2 * k + 1] * norm;
+    }
+  }
+}
+
+/**
+ * @brief    Redshift bin of a galaxy
+ * @param    <index> index of the galaxy in the catalog
+ * @param    <z> redshift of the galaxy
+ * @param    <balancedBin> bins assigned by redshift rank, used with BalancedBins
+ * @param    <zEdges> lower edges of the bins followed by zMax, used otherwise
+ * @return   redshift bin, -1 when the galaxy is outside [zMin, zMax[
+ */
+template <bool BalancedBins>
+int redshiftBin(std::size_t index, double z, const std::vector<int>& balancedBin,
+                const std::vector<double>& zEdges) {
+  if (BalancedBins) {
+    return balancedBin[index];
+  }
+  int zbin = static_cast<int>(std::upper_bound(zEdges.begin(), zEdges.end(), z) - zEdges.begin()) - 1;
+  return zbin >= static_cast<int>(zEdges.size()) - 1 ? -1 : zbin;
+}
+
+}  // namespace Kernels
+
+}  // namespace DmModule
+
+
+#endif
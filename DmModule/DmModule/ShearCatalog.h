@@ -0,0 +1,84 @@
+/**
+ * @file DmModule/ShearCatalog.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_SHEARCATALOG_H
+#define _DMMODULE_SHEARCATALOG_H
+
+#include <cstddef>
+#include <vector>
+#include <boost/filesystem.hpp>
+#include "ElementsKernel/Logging.h"
+
+namespace DmModule {
+
+/**
+ * @class ShearCatalog
+ * @brief Shear catalog held in memory, one vector per column
+ *
+ */
+class ShearCatalog {
+
+public:
+
+  /**
+   * @brief    Constructor from columns, all of the same length
+   * @param    <ra> Right ascension in degrees
+   * @param    <dec> Declination in degrees
+   * @param    <gamma1> first shear component
+   * @param    <gamma2> second shear component
+   * @param    <weight> weight of the galaxies
+   * @param    <z> redshift of the galaxies
+   */
+  ShearCatalog(std::vector<double> ra, std::vector<double> dec, std::vector<double> gamma1,
+               std::vector<double> gamma2, std::vector<double> weight, std::vector<double> z);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~ShearCatalog() = default;
+
+  /**
+   * @brief     Read the shear catalog from the first binary table of a FITS file
+   * @param     <catalog_file> <filesystem::path> path and name of the FITS catalog
+   * @return    Catalog with all the rows of the table
+   */
+  static ShearCatalog readFits(const boost::filesystem::path& catalog_file);
+
+  std::size_t getNbGalaxies() const { return m_ra.size(); }
+  const std::vector<double>& getRa() const { return m_ra; }
+  const std::vector<double>& getDec() const { return m_dec; }
+  const std::vector<double>& getGamma1() const { return m_gamma1; }
+  const std::vector<double>& getGamma2() const { return m_gamma2; }
+  const std::vector<double>& getWeight() const { return m_weight; }
+  const std::vector<double>& getZ() const { return m_z; }
+
+private:
+
+  std::vector<double> m_ra, m_dec, m_gamma1, m_gamma2, m_weight, m_z;
+
+};  // End of ShearCatalog class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file DmModule/Starlet.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_STARLET_H
+#define _DMMODULE_STARLET_H
+
+#include <cstddef>
+#include <vector>
+
+namespace DmModule {
+
+/**
+ * @class Starlet
+ * @brief Isotropic undecimated wavelet transform (a trous algorithm with a B3-spline)
+ *
+ * The coefficients of an image are stored scale after scale, the wavelet scales
+ * first, from the finest to the coarsest, followed by the smooth approximation.
+ * The image is the sum of all the scales.
+ */
+class Starlet {
+
+public:
+
+  /**
+   * @brief    Constructor
+   * @param    <xdim> number of pixels along X-axis of the images
+   * @param    <ydim> number of pixels along Y-axis of the images
+   * @param    <nbScales> number of scales including the smooth approximation, 0 for automatic
+   */
+  Starlet(std::size_t xdim, std::size_t ydim, int nbScales = 0);
+
+  /**
+   * @brief Destructor
+   */
+  virtual ~Starlet() = default;
+
+  /**
+   * @brief   function to return the number of scales including the smooth approximation
+   * @return  number of scales
+   */
+  int getNbScales() const { return m_nbScales; }
+
+  /**
+   * @brief    Wavelet transform
+   * @param    <image> xdim * ydim pixels
+   * @param    <coefficients> output, resized to nbScales * xdim * ydim
+   */
+  void transform(const double* image, std::vector<double>& coefficients) const;
+
+  /**
+   * @brief    Inverse transform, sum of the scales
+   * @param    <coefficients> nbScales * xdim * ydim coefficients
+   * @param    <image> output xdim * ydim pixels
+   */
+  void reconstruct(const std::vector<double>& coefficients, double* image) const;
+
+private:
+
+  void smooth(const double* in, double* out, std::size_t step) const;
+
+  std::size_t m_xdim, m_ydim;
+  int m_nbScales;
+  mutable std::vector<double> m_work;
+
+};  // End of Starlet class
+
+}  // namespace DmModule
+
+
+#endif
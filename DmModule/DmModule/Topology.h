@@ -0,0 +1,104 @@
+/**
+ * @file DmModule/Topology.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_TOPOLOGY_H
+#define _DMMODULE_TOPOLOGY_H
+
+#include <string>
+#include <vector>
+#include <boost/filesystem.hpp>
+
+namespace DmModule {
+
+/**
+ * @class Topology
+ * @brief NUMA nodes of the machine and the CPUs of each node
+ *
+ * The nodes are read from sysfs and restricted to the CPUs the process may run
+ * on; a machine without NUMA information is seen as a single node.
+ */
+class Topology {
+
+public:
+
+  /**
+   * @brief    Reads the topology of the machine
+   * @param    <sysfs_dir> directory holding the nodeN/cpulist files, N being
+   *           the kernel id of the node, not necessarily contiguous
+   * @return   nodes with at least one CPU available to the process
+   */
+  static Topology detect(const boost::filesystem::path& sysfs_dir = "/sys/devices/system/node");
+
+  /**
+   * @brief    Parses a kernel CPU list
+   * @param    <list> CPU list, e.g. "0-3,8,10-11"
+   * @return   CPU numbers in increasing order
+   */
+  static std::vector<int> parseCpuList(const std::string& list);
+
+  /**
+   * @brief    Restricts the calling thread to a set of CPUs
+   * @param    <cpus> CPU numbers
+   * @return   false if the affinity could not be set
+   */
+  static bool pinCurrentThread(const std::vector<int>& cpus);
+
+  /**
+   * @brief    Constructor
+   * @param    <node_cpus> CPUs of each node, the empty nodes are dropped; without
+   *           any CPU, a single node with the CPUs available to the process;
+   *           the id of each node is its position in node_cpus
+   */
+  explicit Topology(std::vector<std::vector<int>> node_cpus);
+
+  /**
+   * @brief   function to return the number of nodes
+   * @return  number of nodes, at least 1
+   */
+  unsigned getNbNodes() const { return static_cast<unsigned>(m_nodeCpus.size()); }
+
+  /**
+   * @brief   function to return the CPUs of a node
+   * @param   <node> index of the node
+   * @return  CPU numbers
+   */
+  const std::vector<int>& getCpus(unsigned node) const { return m_nodeCpus[node]; }
+
+  /**
+   * @brief   function to return the kernel id of a node
+   * @param   <node> index of the node
+   * @return  id of the node in sysfs
+   */
+  int getNodeId(unsigned node) const { return m_nodeIds[node]; }
+
+private:
+
+  std::vector<std::vector<int>> m_nodeCpus;
+  std::vector<int> m_nodeIds;
+
+};  // End of Topology class
+
+}  // namespace DmModule
+
+
+#endif
@@ -0,0 +1,160 @@
+/**
+ * @file DmModule/WorkerPool.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef _DMMODULE_WORKERPOOL_H
+#define _DMMODULE_WORKERPOOL_H
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DmModule/Topology.h"
+
+namespace DmModule {
+
+/**
+ * @class WorkerPool
+ * @brief Fixed size pool of worker threads running tasks in submission order
+ *
+ * With a placement, the workers are spread over the NUMA nodes and pinned to a
+ * core or to the CPUs of their node. Tasks submitted on a node run on the workers
+ * of that node, so the memory they allocate is first touched, and placed, on the
+ * node which uses it. The workers of a node run its tasks first, then the tasks
+ * submitted without a node.
+ */
+class WorkerPool {
+
+public:
+
+  /**
+   * @brief Pinning of the worker threads
+   */
+  enum class Placement {
+    NONE,    ///< not pinned, a single queue
+    CORE,    ///< each worker pinned to one core of its node
+    SOCKET   ///< each worker pinned to the CPUs of its node
+  };
+
+  /**
+   * @brief    Placement from its name
+   * @param    <name> none, core or socket
+   * @return   placement
+   */
+  static Placement parsePlacement(const std::string& name);
+
+  /**
+   * @brief   function to return the node of the calling worker thread
+   * @return  index of the node, -1 outside of a placed worker
+   */
+  static int getCurrentNode();
+
+  /**
+   * @brief    Starts the worker threads
+   * @param    <nb_workers> number of threads, 0 means one per hardware thread
+   * @param    <placement> pinning of the threads on the nodes of the machine
+   */
+  explicit WorkerPool(unsigned nb_workers = 0, Placement placement = Placement::NONE);
+
+  /**
+   * @brief    Starts the worker threads on a given topology
+   * @param    <nb_workers> number of threads, 0 means one per CPU of the topology
+   * @param    <placement> pinning of the threads on the nodes
+   * @param    <topology> nodes and their CPUs
+   */
+  WorkerPool(unsigned nb_workers, Placement placement, const Topology& topology);
+
+  /**
+   * @brief Destructor, runs the remaining tasks and joins the workers
+   */
+  virtual ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /**
+   * @brief    Queues a task for execution
+   * @param    <task> callable without arguments
+   * @return   future holding the result, or the exception thrown by the task
+   */
+  template <typename Task>
+  std::future<typename std::result_of<Task()>::type> submit(Task task) {
+    typedef typename std::result_of<Task()>::type Result;
+    auto job = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = job->get_future();
+    enqueue(-1, [job]() { (*job)(); });
+    return result;
+  }
+
+  /**
+   * @brief    Queues a task for the workers of a node
+   * @param    <node> index of the node, modulo the number of nodes
+   * @param    <task> callable without arguments
+   * @return   future holding the result, or the exception thrown by the task
+   */
+  template <typename Task>
+  std::future<typename std::result_of<Task()>::type> submitOn(unsigned node, Task task) {
+    typedef typename std::result_of<Task()>::type Result;
+    auto job = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = job->get_future();
+    enqueue(static_cast<int>(node % getNbNodes()), [job]() { (*job)(); });
+    return result;
+  }
+
+  /**
+   * @brief   function to return the number of worker threads
+   * @return  number of workers
+   */
+  unsigned getNbWorkers() const;
+
+  /**
+   * @brief   function to return the number of nodes the workers are spread over
+   * @return  number of nodes, 1 without placement
+   */
+  unsigned getNbNodes() const;
+
+private:
+
+  void enqueue(int node, std::function<void()> task);
+
+  void workerLoop(unsigned node, std::vector<int> cpus);
+
+  std::vector<std::thread> m_workers;
+  std::deque<std::function<void()>> m_tasks;
+  std::vector<std::deque<std::function<void()>>> m_nodeTasks;
+  Placement m_placement;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  bool m_stopping;
+
+};  // End of WorkerPool class
+
+}  // namespace DmModule
+
+
+#endif
@@ -26,10 +26,21 @@ Author: user
 
 import os                                 # for the path tools
 import argparse                           # for program options from configuration
+import subprocess                         # for the external map maker
 import ElementsKernel.Logging as log      # for Elements logging support
-from DmModule.DmInput import *            # for DmInput
-from DmModule.DmOutput import *           # for DmOutput
-from DmModule.Parameters import *         # for parameters
+
+#
+# Prefer the compiled C++ bindings (fast XML parsing, zero-copy NumPy views
+# over the Parameters vectors) and fall back on the pure Python classes
+#
+try:
+    from DmModule.DmBindings import DmInput, DmOutput, Parameters
+    FAST_PATH = True
+except ImportError:
+    from DmModule.DmInput import *        # for DmInput
+    from DmModule.DmOutput import *       # for DmOutput
+    from DmModule.Parameters import *     # for parameters
+    FAST_PATH = False
 
 def defineSpecificProgramOptions():
     """
@@ -69,6 +80,11 @@ def mainMethod(args):
     logger.info('# Entering DmProgram mainMethod()')
     logger.info('#')
 
+    if FAST_PATH:
+        logger.info('Using the compiled DmModule bindings')
+    else:
+        logger.info('DmModule bindings not available, using the Python classes')
+
     #
     #  Get the workdir and the data_dir
     #
@@ -103,7 +119,11 @@ def mainMethod(args):
     #
 
     param = Parameters()
-    param.readParameterFile(workdir + os.sep + args.parameter_file)
+    if FAST_PATH:
+        # The C++ readParameterFile returns a new Parameters object
+        param = param.readParameterFile(workdir + os.sep + args.parameter_file)
+    else:
+        param.readParameterFile(workdir + os.sep + args.parameter_file)
 
     #
     # Execute the processing function algorithm
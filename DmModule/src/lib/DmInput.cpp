@@ -54,14 +54,14 @@ DmInput DmInput::readFile(const boost::filesystem::path& in_xml_filename) {
   // Populate the variables catalog_file
   logger.warn() << "TODO: Populate the variables catalog_file";
   fs::path catalog_file;
-  return DmInput(catalog_file);
+  return DmInput(std::move(catalog_file));
 }
 
- DmInput::DmInput(const fs::path& catalog_file)
-      : m_catalog_file{catalog_file} {
+ DmInput::DmInput(fs::path catalog_file)
+      : m_catalog_file{std::move(catalog_file)} {
  }
 
- fs::path DmInput::getFitsCatalogFilename() const {
+ const fs::path& DmInput::getFitsCatalogFilename() const {
   return m_catalog_file;
  }
 }  // namespace DmModule
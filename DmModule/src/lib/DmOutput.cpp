@@ -23,6 +23,15 @@
 
 #include "DmModule/DmOutput.h"
 
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <utility>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/OutputPublisher.h"
+
 namespace fs = boost::filesystem;
 
 // DM Output namespace and classes
@@ -34,80 +43,92 @@ using Euclid::DataModel::GenericHeaderGenerator;
 
 static Elements::Logging logger = Elements::Logging::getLogger("DmOutput");
 
+namespace {
+
+// Tags of the generic header of the products
+const std::pair<const char*, const char*> headerTags[] = {
+  {"SoftwareName", "2D-MASS-WL"},
+  {"ProdSDC", "SDC-FR"},
+  {"Curator", "LOCAL"},
+};
+
+}  // namespace
+
 namespace DmModule {
 
  Euclid::DataModel::GenericHeaderGenerator* DmOutput::GetGenericHeader() {
     const std::string productType = "LE3Product";
 	GenericHeaderGenerator* generator = new GenericHeaderGenerator("LE3Product");
-    generator->setTagValue("ProdSDC", "SDC-FR");
-    generator->setTagValue("SoftwareName", "2D-MASS-WL");
-    generator->setTagValue("Curator", "LOCAL");
+    for (const auto& tag : headerTags) {
+      generator->setTagValue(tag.first, tag.second);
+    }
 
     return generator;
  }
 
 void DmOutput::createOutputXml(const boost::filesystem::path& out_xml_filename,
-                               const boost::filesystem::path& fits_out_filename) {
-  logger.info() << "Creating PF output XML product in file " << out_xml_filename << "...";
-
-  //
-  // Exercise
-  // ---------------------------------------------------------
-  // Create a data container pointing to the fits_out_filename. Assign it to
-  // the a variable named "output". (Tip: you can just uncomment the lines below)
-  logger.warn() << "TODO: Create a data container pointing to the fits_out_filename";
-//  logger.warn() << "Create a data container pointing to the" << fits_out_filename << "......";
-//  boost::filesystem::path fits_file {fits_out_filename};
-//  sys::dss::dataContainer output (fits_file.filename().string(), "PROPOSED");
+                               const boost::filesystem::path& fits_out_filename,
+                               int nbResamples, const std::string& exitStatusCode) {
+  logger.info() << "Creating PF output XML product in file " << out_xml_filename << " pointing to "
+                << fits_out_filename.filename() << "...";
 
-  // Create the Generic header of output file
-  logger.info() << "Create the generic header of the product";
-  GenericHeaderGenerator* generator = GetGenericHeader();
-  generator->changeProductType("DpdTwoDMassConvergencePatch");
-  sys::genericHeader *header = generator->generate();
-
-  // Exercise
-  // ---------------------------------------------------------
-  // Create the Output Map element (Tip: you can just uncomment the lines below)
-  logger.warn() << "TODO: Create the Output Map element";
-   //pro::le3::wl::twodmass::twoDMassConvergencePatch NoisyMap(output, "le3.wl.2dmass.output.patchconvergence",
-   //                                                           "0.1");
-
-  // Exercise
-  // ---------------------------------------------------------
-  // Create the Data element
-  logger.warn() << "TODO: Create the Data element";
-  //pro::le3::wl::twodmass::twoDMassCollectConvergencePatch data(0);
-
-  // Exercise
-  // ---------------------------------------------------------
-  // Create the product XML root element / Create the final object
-  logger.warn() << "TODO: Create the product XML root element";
-  //dpd::le3::wl::twodmass::out::convergencepatch::dpdTwoDMassConvergencePatch product(*header, data);
+  std::string product = createProduct(fits_out_filename, nbResamples, exitStatusCode);
 
   //
-  // Exercise
-  // ---------------------------------------------------------
-  // Create the optional output Map element
-  //
-  logger.warn() << "TODO: Create the optional output Map element";
-  //product.Data().NoisyConvergence(pro::le3::wl::twodmass::twoDMassCollectConvergencePatch::NoisyConvergence_type{NoisyMap});
-  //auto& noisemaplist = product.Data().NoisyConvergence().get().DataContainer();
-  //noisemaplist.FileName(fits_out_filename.string());
-  //
-  // Exercise
-  // ---------------------------------------------------------
   // Create the file out_xml_filename with the XML representing the product
   //
-  logger.warn() << "TODO: Create the output product XML file";
-  //std::ofstream out;
-  //out.open (out_xml_filename.string());
-  //dpd::le3::wl::twodmass::out::convergencepatch::DpdTwoDMassConvergencePatch(out, product);
+  std::ofstream out(out_xml_filename.string(), std::ios::trunc);
+  out << product;
+  out.close();
+  if (!out) {
+    throw Elements::Exception() << "Cannot write output XML product " << out_xml_filename;
+  }
 
   logger.info() << "Finished creating file " << out_xml_filename;
 
 }
 
+void DmOutput::createOutputXml(const boost::filesystem::path& out_xml_filename,
+                               const boost::filesystem::path& fits_out_filename,
+                               OutputPublisher& publisher, int nbResamples) {
+  logger.info() << "Submitting PF output XML product " << out_xml_filename << " pointing to "
+                << fits_out_filename.filename() << " for publication...";
+  publisher.publish(out_xml_filename, createProduct(fits_out_filename, nbResamples));
+}
+
+std::string DmOutput::createProduct(const boost::filesystem::path& fits_out_filename, int nbResamples,
+                                    const std::string& exitStatusCode) {
+  //
+  // Data container pointing to the fits_out_filename. The file name does not include
+  // any path and the filestatus is "PROPOSED". A compressed file is recorded with its
+  // ".fz" suffix, CFITSIO reads it as any other FITS file.
+  //
+  boost::filesystem::path fits_file {fits_out_filename};
+  sys::dss::dataContainer output (fits_file.filename().string(), "PROPOSED");
+
+  // Create the Generic header of output file
+  std::unique_ptr<GenericHeaderGenerator> generator(GetGenericHeader());
+  generator->changeProductType("DpdTwoDMassConvergencePatch");
+  generator->setTagValue("ExitStatusCode", exitStatusCode);
+  std::unique_ptr<sys::genericHeader> header(generator->generate());
+
+  // Output Map element, Data element and product XML root element
+  pro::le3::wl::twodmass::twoDMassConvergencePatch NoisyMap(output, "le3.wl.2dmass.output.patchconvergence",
+                                                             "0.1");
+  pro::le3::wl::twodmass::twoDMassCollectConvergencePatch data(nbResamples);
+  dpd::le3::wl::twodmass::out::convergencepatch::dpdTwoDMassConvergencePatch product(*header, data);
+
+  // Optional output Map element
+  product.Data().NoisyConvergence(pro::le3::wl::twodmass::twoDMassCollectConvergencePatch::NoisyConvergence_type{NoisyMap});
+
+  //
+  // XML representing the product
+  //
+  std::ostringstream out;
+  dpd::le3::wl::twodmass::out::convergencepatch::DpdTwoDMassConvergencePatch(out, product);
+  return out.str();
+}
+
 }  // namespace DmModule
 
 
@@ -0,0 +1,136 @@
+/**
+ * @file src/lib/FftPlanCache.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/FftPlanCache.h"
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("FftPlanCache");
+
+namespace DmModule {
+
+ FftPlanCache& FftPlanCache::getInstance() {
+  static FftPlanCache cache;
+  return cache;
+ }
+
+ FftPlanCache::Effort FftPlanCache::parseEffort(const std::string& name) {
+  if (name == "estimate") {
+    return Effort::ESTIMATE;
+  }
+  if (name == "measure") {
+    return Effort::MEASURE;
+  }
+  if (name == "patient") {
+    return Effort::PATIENT;
+  }
+  throw Elements::Exception() << "Unknown FFT planner effort \"" << name << "\", expected estimate, measure or patient";
+ }
+
+ FftPlanCache::FftPlanCache(): m_flags(FFTW_ESTIMATE) {
+ }
+
+ FftPlanCache::~FftPlanCache() {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  for (auto& entry : m_plans) {
+    fftw_destroy_plan(entry.second.forward);
+    fftw_destroy_plan(entry.second.backward);
+  }
+ }
+
+ FftPlanCache::Plans FftPlanCache::getPlans(std::size_t xdim, std::size_t ydim, std::size_t batch) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto key = std::make_tuple(xdim, ydim, batch);
+  auto it = m_plans.find(key);
+  if (it != m_plans.end()) {
+    return it->second;
+  }
+
+  // The measuring planners overwrite the arrays, the plans are made on a scratch
+  // buffer with the alignment of the buffers they will be executed on
+  std::size_t nbPixels = xdim * ydim;
+  fftw_complex* scratch = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * nbPixels * batch));
+  if (scratch == nullptr) {
+    throw Elements::Exception() << "Cannot allocate the FFT buffer of " << batch << " grids of " << xdim << "x"
+                                << ydim << " pixels";
+  }
+  logger.debug() << "Planning batches of " << batch << " FFTs of " << xdim << "x" << ydim << " pixels";
+  int n[2] = {static_cast<int>(ydim), static_cast<int>(xdim)};
+  int dist = static_cast<int>(nbPixels);
+  Plans plans;
+  plans.forward = fftw_plan_many_dft(2, n, static_cast<int>(batch), scratch, nullptr, 1, dist,
+                                     scratch, nullptr, 1, dist, FFTW_FORWARD, m_flags);
+  plans.backward = fftw_plan_many_dft(2, n, static_cast<int>(batch), scratch, nullptr, 1, dist,
+                                      scratch, nullptr, 1, dist, FFTW_BACKWARD, m_flags);
+  fftw_free(scratch);
+  if (plans.forward == nullptr || plans.backward == nullptr) {
+    // the plan which succeeded is not cached, it would leak
+    if (plans.forward != nullptr) {
+      fftw_destroy_plan(plans.forward);
+    }
+    if (plans.backward != nullptr) {
+      fftw_destroy_plan(plans.backward);
+    }
+    throw Elements::Exception() << "Cannot plan the FFTs of " << xdim << "x" << ydim << " pixels";
+  }
+  m_plans[key] = plans;
+  return plans;
+ }
+
+ void FftPlanCache::setEffort(Effort effort) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_flags = effort == Effort::PATIENT ? FFTW_PATIENT : (effort == Effort::MEASURE ? FFTW_MEASURE : FFTW_ESTIMATE);
+ }
+
+ bool FftPlanCache::importWisdom(const fs::path& filename) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  if (!fs::exists(filename)) {
+    return false;
+  }
+  if (fftw_import_wisdom_from_filename(filename.c_str()) == 0) {
+    logger.warn() << "Ignoring the FFT wisdom file " << filename << " which cannot be read";
+    return false;
+  }
+  logger.debug() << "Loaded the FFT wisdom from " << filename;
+  return true;
+ }
+
+ void FftPlanCache::exportWisdom(const fs::path& filename) {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  fs::path part = filename.parent_path() / fs::unique_path("." + filename.filename().string() + ".%%%%%%.part");
+  if (fftw_export_wisdom_to_filename(part.c_str()) == 0) {
+    boost::system::error_code error;
+    fs::remove(part, error);
+    throw Elements::Exception() << "Cannot write the FFT wisdom file " << part;
+  }
+  fs::rename(part, filename);
+ }
+
+ std::size_t FftPlanCache::size() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_plans.size();
+ }
+
+}  // namespace DmModule
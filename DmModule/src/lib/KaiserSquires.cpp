@@ -0,0 +1,177 @@
+/**
+ * @file src/lib/KaiserSquires.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/KaiserSquires.h"
+
+#include <algorithm>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+#include "DmModule/KernelDispatch.h"
+#include "DmModule/ReconstructionKernels.h"
+
+static Elements::Logging logger = Elements::Logging::getLogger("KaiserSquires");
+
+namespace {
+
+double frequency(std::size_t i, std::size_t n) {
+  return (i <= n / 2 ? static_cast<double>(i) : static_cast<double>(i) - n) / n;
+}
+
+}  // namespace
+
+namespace DmModule {
+
+struct KaiserSquires::TransformSelector {
+  typedef Transform result_type;
+
+  template <bool AddBorders>
+  Transform run() const {
+    return &KaiserSquires::transform<AddBorders>;
+  }
+};
+
+ KaiserSquires::KaiserSquires(std::size_t xdim, std::size_t ydim, bool addBorders, std::size_t batchSize)
+      : m_xdim(xdim), m_ydim(ydim), m_fftXdim(addBorders ? 2 * xdim : xdim),
+        m_fftYdim(addBorders ? 2 * ydim : ydim), m_xoffset(addBorders ? xdim / 2 : 0),
+        m_yoffset(addBorders ? ydim / 2 : 0), m_batchSize(std::max<std::size_t>(batchSize, 1)),
+        m_transform(dispatchKernel(TransformSelector(), addBorders)) {
+  m_buffer = static_cast<fftw_complex*>(fftw_malloc(sizeof(fftw_complex) * m_fftXdim * m_fftYdim * m_batchSize));
+  if (m_buffer == nullptr) {
+    throw Elements::Exception() << "Cannot allocate FFT buffer of " << m_batchSize << " grids of " << m_fftXdim
+                                << "x" << m_fftYdim << " pixels";
+  }
+  m_plans = FftPlanCache::getInstance().getPlans(m_fftXdim, m_fftYdim, m_batchSize);
+ }
+
+ KaiserSquires::~KaiserSquires() {
+  fftw_free(m_buffer);
+ }
+
+ void KaiserSquires::shearToConvergence(const double* gamma1, const double* gamma2, double* kappaE, double* kappaB) {
+  (this->*m_transform)(1, &gamma1, &gamma2, &kappaE, &kappaB, true);
+ }
+
+ void KaiserSquires::convergenceToShear(const double* kappaE, const double* kappaB, double* gamma1, double* gamma2) {
+  (this->*m_transform)(1, &kappaE, &kappaB, &gamma1, &gamma2, false);
+ }
+
+ void KaiserSquires::shearToConvergence(std::size_t count, const double* const* gamma1, const double* const* gamma2,
+                                        double* const* kappaE, double* const* kappaB) {
+  for (std::size_t first = 0; first < count; first += m_batchSize) {
+    std::size_t size = std::min(m_batchSize, count - first);
+    (this->*m_transform)(size, gamma1 + first, gamma2 + first, kappaE + first, kappaB + first, true);
+  }
+ }
+
+ void KaiserSquires::convergenceToShear(std::size_t count, const double* const* kappaE, const double* const* kappaB,
+                                        double* const* gamma1, double* const* gamma2) {
+  for (std::size_t first = 0; first < count; first += m_batchSize) {
+    std::size_t size = std::min(m_batchSize, count - first);
+    (this->*m_transform)(size, kappaE + first, kappaB + first, gamma1 + first, gamma2 + first, false);
+  }
+ }
+
+ void KaiserSquires::checkShape(const PatchMap& map) const {
+  if (map.getXdim() != m_xdim || map.getYdim() != m_ydim) {
+    throw Elements::Exception() << "Shear map of " << map.getXdim() << "x" << map.getYdim()
+                                << " pixels given to a " << m_xdim << "x" << m_ydim << " Kaiser-Squires";
+  }
+ }
+
+ PatchMap KaiserSquires::shearToConvergence(const PatchMap& shearMap) {
+  checkShape(shearMap);
+  PatchMap kappa(m_xdim, m_ydim, 2, shearMap.getPixelSize(), shearMap.getCenterX(), shearMap.getCenterY());
+  shearToConvergence(shearMap.getLayer(0), shearMap.getLayer(1), kappa.getLayer(0), kappa.getLayer(1));
+  return kappa;
+ }
+
+ std::vector<PatchMap> KaiserSquires::shearToConvergence(const std::vector<PatchMap>& shearMaps) {
+  std::vector<PatchMap> kappa;
+  kappa.reserve(shearMaps.size());
+  std::vector<const double*> gamma1, gamma2;
+  std::vector<double*> kappaE, kappaB;
+  for (const auto& shearMap : shearMaps) {
+    checkShape(shearMap);
+    kappa.emplace_back(m_xdim, m_ydim, 2, shearMap.getPixelSize(), shearMap.getCenterX(), shearMap.getCenterY());
+    gamma1.push_back(shearMap.getLayer(0));
+    gamma2.push_back(shearMap.getLayer(1));
+  }
+  for (auto& map : kappa) {
+    kappaE.push_back(map.getLayer(0));
+    kappaB.push_back(map.getLayer(1));
+  }
+  shearToConvergence(shearMaps.size(), gamma1.data(), gamma2.data(), kappaE.data(), kappaB.data());
+  return kappa;
+ }
+
+ template <bool AddBorders>
+ void KaiserSquires::transform(std::size_t count, const double* const* in1, const double* const* in2,
+                               double* const* out1, double* const* out2, bool toConvergence) {
+  std::size_t nbFftPixels = m_fftXdim * m_fftYdim;
+  FftPlanCache::Plans plans = count == m_batchSize ? m_plans
+                                                   : FftPlanCache::getInstance().getPlans(m_fftXdim, m_fftYdim, count);
+  if (AddBorders) {
+    std::fill(&m_buffer[0][0], &m_buffer[0][0] + 2 * nbFftPixels * count, 0.);
+  }
+  for (std::size_t g = 0; g < count; ++g) {
+    Kernels::packGrid<AddBorders>(in1[g], in2[g], &m_buffer[g * nbFftPixels][0], m_xdim, m_ydim, m_fftXdim,
+                                  m_xoffset, m_yoffset);
+  }
+
+  fftw_execute_dft(plans.forward, m_buffer, m_buffer);
+
+  // kappa = conj(D) gamma and gamma = D kappa, with D = (k1^2 - k2^2 + 2i k1 k2) / k^2,
+  // D is computed once per frequency for all the grids of the batch
+  double sign = toConvergence ? -1. : 1.;
+  for (std::size_t j = 0; j < m_fftYdim; ++j) {
+    double k2 = frequency(j, m_fftYdim);
+    for (std::size_t i = 0; i < m_fftXdim; ++i) {
+      double k1 = frequency(i, m_fftXdim);
+      double ksq = k1 * k1 + k2 * k2;
+      double dRe = 0., dIm = 0.;
+      if (ksq != 0.) {
+        dRe = (k1 * k1 - k2 * k2) / ksq;
+        dIm = sign * 2. * k1 * k2 / ksq;
+      }
+      for (std::size_t g = 0; g < count; ++g) {
+        fftw_complex& value = m_buffer[g * nbFftPixels + j * m_fftXdim + i];
+        double re = value[0] * dRe - value[1] * dIm;
+        double im = value[0] * dIm + value[1] * dRe;
+        value[0] = re;
+        value[1] = im;
+      }
+    }
+  }
+
+  fftw_execute_dft(plans.backward, m_buffer, m_buffer);
+
+  double norm = 1. / nbFftPixels;
+  for (std::size_t g = 0; g < count; ++g) {
+    Kernels::unpackGrid<AddBorders>(&m_buffer[g * nbFftPixels][0], norm, out1[g], out2[g], m_xdim, m_ydim,
+                                    m_fftXdim, m_xoffset, m_yoffset);
+  }
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,219 @@
+/**
+ * @file src/lib/MapMaker.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/MapMaker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/KernelDispatch.h"
+#include "DmModule/ReconstructionKernels.h"
+
+static Elements::Logging logger = Elements::Logging::getLogger("MapMaker");
+
+namespace {
+
+const double deg2rad = M_PI / 180.;
+
+}  // namespace
+
+namespace DmModule {
+
+template <typename Visitor>
+struct MapMaker::LocateKernel {
+  typedef void result_type;
+
+  template <bool BalancedBins>
+  void run() const {
+    self.locateGalaxies<BalancedBins>(catalog, balancedBin, visit);
+  }
+
+  const MapMaker& self;
+  const ShearCatalog& catalog;
+  const std::vector<int>& balancedBin;
+  Visitor& visit;
+};
+
+ MapMaker::MapMaker(Parameters& param)
+      : m_nbPixels(static_cast<std::size_t>(std::lround(param.getPatchWidth() / param.getPixelsize()))),
+        m_pixelSize(param.getPixelsize()), m_centerX(param.getMapCenterX()), m_centerY(param.getMapCenterY()),
+        m_balancedBins(param.get_BalancedBins() != 0) {
+
+  std::size_t nbPatches = param.getnbPatches();
+  if (m_centerX.size() < nbPatches || m_centerY.size() < nbPatches) {
+    throw Elements::Exception() << "Map centers are given for " << std::min(m_centerX.size(), m_centerY.size())
+                                << " patches, " << nbPatches << " are expected";
+  }
+  m_centerX.resize(nbPatches);
+  m_centerY.resize(nbPatches);
+
+  // Redshift bins: the zMin values are the lower edges when there is one per bin,
+  // otherwise [zMin, zMax] is split in bins of equal width
+  std::size_t nbZBins = std::max(1, param.getnbZBins());
+  const std::vector<double>& zMin = param.getZMin();
+  double zMax = param.getZMax();
+  if (zMin.size() == nbZBins) {
+    m_zEdges = zMin;
+  } else {
+    double zLow = zMin.empty() ? 0. : zMin.front();
+    for (std::size_t i = 0; i < nbZBins; ++i) {
+      m_zEdges.push_back(zLow + i * (zMax - zLow) / nbZBins);
+    }
+  }
+  m_zEdges.push_back(zMax);
+ }
+
+ std::vector<PatchMap> MapMaker::makeShearMaps(const ShearCatalog& catalog) const {
+  std::size_t nbPatches = m_centerX.size();
+  std::size_t nbZBins = m_zEdges.size() - 1;
+  std::size_t nbGalaxies = catalog.getNbGalaxies();
+  logger.info() << "Binning " << nbGalaxies << " galaxies in " << nbPatches << " patches of "
+                << m_nbPixels << "x" << m_nbPixels << " pixels and " << nbZBins << " redshift bins";
+
+  std::vector<int> balancedBin = balanceBins(catalog);
+  std::vector<PatchMap> maps = makeMaps();
+  std::vector<std::vector<double>> weightSums(maps.size(), std::vector<double>(m_nbPixels * m_nbPixels, 0.));
+
+  const std::vector<double>& gamma1 = catalog.getGamma1();
+  const std::vector<double>& gamma2 = catalog.getGamma2();
+  const std::vector<double>& weight = catalog.getWeight();
+  auto bin = [&](std::size_t i, std::size_t m, std::size_t ix, std::size_t iy) {
+    PatchMap& map = maps[m];
+    map(0, ix, iy) += weight[i] * gamma1[i];
+    map(1, ix, iy) += weight[i] * gamma2[i];
+    map(2, ix, iy) += 1.;
+    weightSums[m][iy * m_nbPixels + ix] += weight[i];
+  };
+  dispatchKernel(LocateKernel<decltype(bin)>{*this, catalog, balancedBin, bin}, m_balancedBins);
+
+  for (std::size_t m = 0; m < maps.size(); ++m) {
+    double* g1 = maps[m].getLayer(0);
+    double* g2 = maps[m].getLayer(1);
+    const std::vector<double>& sums = weightSums[m];
+    for (std::size_t k = 0; k < sums.size(); ++k) {
+      if (sums[k] > 0.) {
+        g1[k] /= sums[k];
+        g2[k] /= sums[k];
+      }
+    }
+  }
+
+  return maps;
+ }
+
+ MapMaker::Footprint MapMaker::makeFootprint(const ShearCatalog& catalog) const {
+  std::vector<int> balancedBin = balanceBins(catalog);
+  Footprint footprint {{}, {}, makeMaps()};
+  std::size_t nbMapPixels = m_nbPixels * m_nbPixels;
+  auto locate = [&footprint, nbMapPixels, this](std::size_t i, std::size_t m, std::size_t ix, std::size_t iy) {
+    footprint.galaxies.push_back(i);
+    footprint.pixels.push_back(m * nbMapPixels + iy * m_nbPixels + ix);
+    footprint.maps[m](2, ix, iy) += 1.;
+  };
+  dispatchKernel(LocateKernel<decltype(locate)>{*this, catalog, balancedBin, locate}, m_balancedBins);
+  logger.debug() << "Footprint of " << footprint.galaxies.size() << " entries for " << catalog.getNbGalaxies()
+                 << " galaxies";
+  return footprint;
+ }
+
+ std::vector<int> MapMaker::balanceBins(const ShearCatalog& catalog) const {
+  // With balanced bins, the galaxies inside [zMin, zMax[ are sorted by redshift
+  // and shared out so that every bin gets the same number of galaxies
+  std::vector<int> balancedBin;
+  if (m_balancedBins) {
+    std::size_t nbZBins = m_zEdges.size() - 1;
+    std::size_t nbGalaxies = catalog.getNbGalaxies();
+    const std::vector<double>& z = catalog.getZ();
+    std::vector<std::size_t> order;
+    for (std::size_t i = 0; i < nbGalaxies; ++i) {
+      if (z[i] >= m_zEdges.front() && z[i] < m_zEdges.back()) {
+        order.push_back(i);
+      }
+    }
+    std::sort(order.begin(), order.end(), [&z](std::size_t a, std::size_t b) { return z[a] < z[b]; });
+    balancedBin.assign(nbGalaxies, -1);
+    for (std::size_t rank = 0; rank < order.size(); ++rank) {
+      balancedBin[order[rank]] = static_cast<int>(rank * nbZBins / order.size());
+    }
+  }
+  return balancedBin;
+ }
+
+ std::vector<PatchMap> MapMaker::makeMaps() const {
+  std::size_t nbPatches = m_centerX.size();
+  std::size_t nbZBins = m_zEdges.size() - 1;
+  std::vector<PatchMap> maps;
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    for (std::size_t b = 0; b < nbZBins; ++b) {
+      maps.emplace_back(m_nbPixels, m_nbPixels, 3, m_pixelSize, m_centerX[p], m_centerY[p]);
+    }
+  }
+  return maps;
+ }
+
+ template <bool BalancedBins, typename Visitor>
+ void MapMaker::locateGalaxies(const ShearCatalog& catalog, const std::vector<int>& balancedBin,
+                               Visitor& visit) const {
+  std::size_t nbPatches = m_centerX.size();
+  std::size_t nbZBins = m_zEdges.size() - 1;
+  std::size_t nbGalaxies = catalog.getNbGalaxies();
+  const std::vector<double>& ra = catalog.getRa();
+  const std::vector<double>& dec = catalog.getDec();
+  const std::vector<double>& z = catalog.getZ();
+
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    double ra0 = m_centerX[p] * deg2rad, dec0 = m_centerY[p] * deg2rad;
+    double sinDec0 = std::sin(dec0), cosDec0 = std::cos(dec0);
+    double half = m_nbPixels / 2.;
+
+    for (std::size_t i = 0; i < nbGalaxies; ++i) {
+      int zbin = Kernels::redshiftBin<BalancedBins>(i, z[i], balancedBin, m_zEdges);
+      if (zbin < 0) {
+        continue;
+      }
+
+      // Gnomonic projection on the plane tangent to the patch center
+      double dRa = ra[i] * deg2rad - ra0;
+      double sinDec = std::sin(dec[i] * deg2rad), cosDec = std::cos(dec[i] * deg2rad);
+      double cosC = sinDec0 * sinDec + cosDec0 * cosDec * std::cos(dRa);
+      if (cosC <= 0.) {
+        continue;
+      }
+      double x = cosDec * std::sin(dRa) / cosC / deg2rad;
+      double y = (cosDec0 * sinDec - sinDec0 * cosDec * std::cos(dRa)) / cosC / deg2rad;
+
+      double px = std::floor(x / m_pixelSize + half), py = std::floor(y / m_pixelSize + half);
+      if (px < 0 || py < 0 || px >= m_nbPixels || py >= m_nbPixels) {
+        continue;
+      }
+      std::size_t ix = static_cast<std::size_t>(px), iy = static_cast<std::size_t>(py);
+
+      visit(i, p * nbZBins + zbin, ix, iy);
+    }
+  }
+ }
+
+}  // namespace DmModule
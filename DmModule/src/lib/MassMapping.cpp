@@ -0,0 +1,474 @@
+/**
+ * @file src/lib/MassMapping.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/MassMapping.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+#include "DmModule/KernelDispatch.h"
+#include "DmModule/ReconstructionKernels.h"
+
+static Elements::Logging logger = Elements::Logging::getLogger("MassMapping");
+
+namespace {
+
+/*
+ * Separable gaussian filter, sigma in pixels, mirrored borders
+ */
+void gaussianSmooth(double* image, std::size_t xdim, std::size_t ydim, double sigma) {
+  long radius = static_cast<long>(std::ceil(4. * sigma));
+  std::vector<double> kernel(2 * radius + 1);
+  double sum = 0.;
+  for (long t = -radius; t <= radius; ++t) {
+    kernel[t + radius] = std::exp(-0.5 * t * t / (sigma * sigma));
+    sum += kernel[t + radius];
+  }
+  for (auto& value : kernel) {
+    value /= sum;
+  }
+
+  long nx = static_cast<long>(xdim), ny = static_cast<long>(ydim);
+  auto clampIndex = [](long i, long n) {
+    return i < 0 ? std::min(-i, n - 1) : (i >= n ? std::max(2 * n - 2 - i, 0L) : i);
+  };
+  std::vector<double> work(xdim * ydim);
+  for (long y = 0; y < ny; ++y) {
+    for (long x = 0; x < nx; ++x) {
+      double value = 0.;
+      for (long t = -radius; t <= radius; ++t) {
+        value += kernel[t + radius] * image[y * nx + clampIndex(x + t, nx)];
+      }
+      work[y * nx + x] = value;
+    }
+  }
+  for (long y = 0; y < ny; ++y) {
+    for (long x = 0; x < nx; ++x) {
+      double value = 0.;
+      for (long t = -radius; t <= radius; ++t) {
+        value += kernel[t + radius] * work[clampIndex(y + t, ny) * nx + x];
+      }
+      image[y * nx + x] = value;
+    }
+  }
+}
+
+/*
+ * Benjamini-Hochberg selection of the significant coefficients of each wavelet scale,
+ * the noise level of a scale being estimated from its median absolute deviation
+ */
+void fdrThreshold(std::vector<double>& coefficients, std::size_t nbPixels, int nbScales, double alpha) {
+  std::vector<double> work(nbPixels);
+  for (int s = 0; s < nbScales - 1; ++s) {
+    double* scale = coefficients.data() + s * nbPixels;
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      work[k] = std::fabs(scale[k]);
+    }
+    std::nth_element(work.begin(), work.begin() + nbPixels / 2, work.end());
+    double sigma = work[nbPixels / 2] / 0.6745;
+    if (sigma <= 0.) {
+      continue;
+    }
+
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      work[k] = std::erfc(std::fabs(scale[k]) / (sigma * M_SQRT2));
+    }
+    std::sort(work.begin(), work.end());
+    double pThreshold = -1.;
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      if (work[k] <= alpha * (k + 1) / nbPixels) {
+        pThreshold = work[k];
+      }
+    }
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      if (std::erfc(std::fabs(scale[k]) / (sigma * M_SQRT2)) > pThreshold) {
+        scale[k] = 0.;
+      }
+    }
+  }
+}
+
+// Inpainting threshold at which the early stopping starts, in noise standard deviations
+const double noiseThreshold = 3.;
+
+/*
+ * Change of a map between two iterations, relative to the L2 norm of the map
+ */
+double relativeChange(const double* previous, const double* current, std::size_t nbPixels) {
+  double change = 0., norm = 0.;
+  for (std::size_t k = 0; k < nbPixels; ++k) {
+    change += (current[k] - previous[k]) * (current[k] - previous[k]);
+    norm += current[k] * current[k];
+  }
+  return norm > 0. ? std::sqrt(change / norm) : (change > 0. ? HUGE_VAL : 0.);
+}
+
+}  // namespace
+
+namespace DmModule {
+
+const std::size_t MassMapping::batchSize;
+
+struct MassMapping::ReconstructKernel {
+  typedef std::vector<PatchMap> result_type;
+
+  template <bool ForceBMode, bool EqualVarPerScale>
+  std::vector<PatchMap> run() const {
+    return self.reconstructWith<ForceBMode, EqualVarPerScale>(shearMaps, warmStarts, solutions, iterations);
+  }
+
+  const MassMapping& self;
+  const std::vector<const PatchMap*>& shearMaps;
+  const std::vector<PatchMap>& warmStarts;
+  std::vector<PatchMap>& solutions;
+  std::vector<Iterations>& iterations;
+};
+
+/*
+ * Working maps of a patch, the layers of its convergence map are the outputs
+ */
+struct MassMapping::Patch {
+  std::vector<char> mask;
+  std::vector<double> gamma1, gamma2;
+  PatchMap kappa;
+  const double* startE;    // convergence filling the gaps before the inpainting, nullptr for none
+  const double* startB;
+  Iterations iterations;
+};
+
+ MassMapping::MassMapping(Parameters& param)
+      : m_NInpaint(param.getNInpaint()), m_NItReducedShear(param.getNItReducedShear()),
+        m_nbScales(param.getnbScales()), m_forceBMode(param.getForceBMode() != 0),
+        m_equalVarPerScale(param.getEqualVarPerScale() != 0), m_addBorders(param.get_addBorders() != 0),
+        m_sigmaGauss(param.getSigmaGauss()), m_thresholdFDR(param.getThreshold()),
+        m_RSsigmaGauss(param.getRSSigmaGauss()), m_RSthresholdFDR(param.getRSThreshold()), m_tolerance(param.getConvergenceTolerance()),
+        m_transforms(std::make_shared<BufferPool<std::array<std::size_t, 3>, KaiserSquires>>()) {
+ }
+
+ PatchMap MassMapping::reconstruct(const PatchMap& shearMap, Iterations* iterations) const {
+  std::vector<const PatchMap*> shearMaps {&shearMap};
+  std::vector<PatchMap> warmStarts, solutions;
+  std::vector<Iterations> patchIterations;
+  PatchMap kappa = std::move(dispatchKernel(ReconstructKernel{*this, shearMaps, warmStarts, solutions, patchIterations},
+                                            m_forceBMode, m_equalVarPerScale).front());
+  if (iterations != nullptr) {
+    *iterations = patchIterations.front();
+  }
+  return kappa;
+ }
+
+ std::vector<PatchMap> MassMapping::reconstruct(const std::vector<PatchMap>& shearMaps,
+                                                std::vector<Iterations>* iterations, std::size_t nbZBins) const {
+  if (nbZBins == 0 || shearMaps.size() % nbZBins != 0) {
+    throw Elements::Exception() << "Cannot reconstruct " << shearMaps.size() << " maps of patches with "
+                                << nbZBins << " redshift bins each";
+  }
+  // The map of patch p and redshift bin z is at p * nbZBins + z. A batch holds the
+  // same redshift bin of consecutive patches, the next batch the next redshift bin
+  // of the same patches, which start from the solutions of the previous bin
+  std::size_t nbPatches = shearMaps.size() / nbZBins;
+  std::vector<std::unique_ptr<PatchMap>> convergenceMaps(shearMaps.size());
+  std::vector<Iterations> patchIterations(shearMaps.size());
+
+  std::size_t first = 0;
+  while (first < nbPatches) {
+    auto sameShape = [&shearMaps, nbZBins, first](std::size_t p) {
+      for (std::size_t z = 0; z < nbZBins; ++z) {
+        if (shearMaps[p * nbZBins + z].getXdim() != shearMaps[first * nbZBins].getXdim()
+            || shearMaps[p * nbZBins + z].getYdim() != shearMaps[first * nbZBins].getYdim()) {
+          return false;
+        }
+      }
+      return true;
+    };
+    std::size_t last = first + 1;
+    while (last < nbPatches && last - first < batchSize && sameShape(last)) {
+      ++last;
+    }
+    std::vector<PatchMap> warmStarts;
+    for (std::size_t z = 0; z < nbZBins; ++z) {
+      std::vector<const PatchMap*> batch;
+      for (std::size_t p = first; p < last; ++p) {
+        batch.push_back(&shearMaps[p * nbZBins + z]);
+      }
+      std::vector<PatchMap> solutions;
+      std::vector<Iterations> batchIterations;
+      auto kappa = dispatchKernel(ReconstructKernel{*this, batch, warmStarts, solutions, batchIterations},
+                                  m_forceBMode, m_equalVarPerScale);
+      for (std::size_t p = first; p < last; ++p) {
+        convergenceMaps[p * nbZBins + z].reset(new PatchMap(std::move(kappa[p - first])));
+        patchIterations[p * nbZBins + z] = batchIterations[p - first];
+      }
+      warmStarts.swap(solutions);
+    }
+    first = last;
+  }
+
+  std::vector<PatchMap> result;
+  result.reserve(shearMaps.size());
+  for (auto& kappa : convergenceMaps) {
+    result.push_back(std::move(*kappa));
+  }
+  if (iterations != nullptr) {
+    iterations->swap(patchIterations);
+  }
+  return result;
+ }
+
+ template <bool ForceBMode, bool EqualVarPerScale>
+ std::vector<PatchMap> MassMapping::reconstructWith(const std::vector<const PatchMap*>& shearMaps,
+                                                    const std::vector<PatchMap>& warmStarts,
+                                                    std::vector<PatchMap>& solutions,
+                                                    std::vector<Iterations>& iterations) const {
+  std::size_t xdim = shearMaps.front()->getXdim(), ydim = shearMaps.front()->getYdim();
+  std::size_t nbPixels = xdim * ydim, nbPatches = shearMaps.size();
+  bool earlyStop = m_tolerance > 0.;
+
+  logger.debug() << "Reconstructing the convergence of " << nbPatches << " " << xdim << "x" << ydim << " maps";
+
+  std::array<std::size_t, 3> shape {{xdim, ydim, nbPatches}};
+  auto transform = m_transforms->acquire(shape, [this, &shape]() {
+    return std::unique_ptr<KaiserSquires>(new KaiserSquires(shape[0], shape[1], m_addBorders, shape[2]));
+  });
+  KaiserSquires& ks = *transform;
+  Starlet starlet(xdim, ydim, m_nbScales);
+
+  std::vector<Patch> patches;
+  patches.reserve(nbPatches);
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    const PatchMap* shearMap = shearMaps[p];
+    const double* nbGalaxies = shearMap->getLayer(2);
+    std::vector<char> mask(nbPixels);
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      mask[k] = nbGalaxies[k] > 0. ? 1 : 0;
+    }
+    bool warm = earlyStop && p < warmStarts.size() && warmStarts[p].getNbPixels() == nbPixels;
+    patches.push_back(Patch{std::move(mask),
+        std::vector<double>(shearMap->getLayer(0), shearMap->getLayer(0) + nbPixels),
+        std::vector<double>(shearMap->getLayer(1), shearMap->getLayer(1) + nbPixels),
+        PatchMap(xdim, ydim, 2, shearMap->getPixelSize(), shearMap->getCenterX(), shearMap->getCenterY()),
+        warm ? warmStarts[p].getLayer(0) : nullptr, warm ? warmStarts[p].getLayer(1) : nullptr, Iterations{0, 0}});
+  }
+  std::vector<double> smoothed(nbPixels);
+  std::vector<std::vector<double>> previous(earlyStop && m_NItReducedShear > 0 ? nbPatches : 0,
+                                            std::vector<double>(nbPixels));
+
+  // The first pass takes the reduced shear as the shear, the next ones use
+  // gamma = g (1 - kappa) with the denoised convergence of the previous pass
+  std::vector<Patch*> active;
+  for (auto& patch : patches) {
+    active.push_back(&patch);
+  }
+  for (int it = 0; it <= m_NItReducedShear && !active.empty(); ++it) {
+    if (it > 0) {
+      for (Patch* patch : active) {
+        std::size_t p = static_cast<std::size_t>(patch - patches.data());
+        const double* reducedShear1 = shearMaps[p]->getLayer(0);
+        const double* reducedShear2 = shearMaps[p]->getLayer(1);
+        double* kappaE = patch->kappa.getLayer(0);
+        std::copy(kappaE, kappaE + nbPixels, smoothed.begin());
+        denoise(starlet, smoothed.data(), xdim, ydim, m_RSsigmaGauss, m_RSthresholdFDR);
+        for (std::size_t k = 0; k < nbPixels; ++k) {
+          patch->gamma1[k] = reducedShear1[k] * (1. - smoothed[k]);
+          patch->gamma2[k] = reducedShear2[k] * (1. - smoothed[k]);
+        }
+        patch->iterations.reducedShear = it;
+        // the inpainting restarts from the solution of the previous pass
+        if (earlyStop) {
+          std::copy(kappaE, kappaE + nbPixels, previous[p].begin());
+          patch->startE = kappaE;
+          patch->startB = patch->kappa.getLayer(1);
+        }
+      }
+    }
+    if (m_NInpaint > 0) {
+      inpaint<ForceBMode, EqualVarPerScale>(ks, starlet, active);
+    } else {
+      std::vector<const double*> gamma1, gamma2;
+      std::vector<double*> kappaE, kappaB;
+      for (Patch* patch : active) {
+        gamma1.push_back(patch->gamma1.data());
+        gamma2.push_back(patch->gamma2.data());
+        kappaE.push_back(patch->kappa.getLayer(0));
+        kappaB.push_back(patch->kappa.getLayer(1));
+      }
+      ks.shearToConvergence(active.size(), gamma1.data(), gamma2.data(), kappaE.data(), kappaB.data());
+    }
+    if (earlyStop && it > 0) {
+      active.erase(std::remove_if(active.begin(), active.end(), [&](Patch* patch) {
+        const std::vector<double>& before = previous[static_cast<std::size_t>(patch - patches.data())];
+        return relativeChange(before.data(), patch->kappa.getLayer(0), nbPixels) < m_tolerance;
+      }), active.end());
+    }
+  }
+
+  // The solutions before the denoising are the warm starts of the next maps
+  std::vector<PatchMap> convergenceMaps;
+  convergenceMaps.reserve(nbPatches);
+  for (auto& patch : patches) {
+    if (earlyStop) {
+      solutions.push_back(patch.kappa);
+    }
+    denoise(starlet, patch.kappa.getLayer(0), xdim, ydim, m_sigmaGauss, m_thresholdFDR);
+    denoise(starlet, patch.kappa.getLayer(1), xdim, ydim, m_sigmaGauss, 0.);
+    convergenceMaps.push_back(std::move(patch.kappa));
+    iterations.push_back(patch.iterations);
+    logger.debug() << "Patch centered on (" << convergenceMaps.back().getCenterX() << ", "
+                   << convergenceMaps.back().getCenterY() << "): " << patch.iterations.inpainting
+                   << " inpainting iterations, " << patch.iterations.reducedShear << " reduced shear corrections";
+  }
+  return convergenceMaps;
+ }
+
+ template <bool ForceBMode, bool EqualVarPerScale>
+ void MassMapping::inpaint(KaiserSquires& ks, const Starlet& starlet, std::vector<Patch*>& patches) const {
+  std::size_t nbPatches = patches.size(), nbPixels = patches.front()->mask.size();
+  int nbScales = starlet.getNbScales();
+  bool earlyStop = m_tolerance > 0.;
+  std::vector<double> coefficients;
+  std::vector<std::vector<double>> estimates1(nbPatches, std::vector<double>(nbPixels)), estimates2 = estimates1;
+  std::vector<std::vector<double>> previous(earlyStop ? nbPatches : 0, std::vector<double>(nbPixels));
+
+  // Measured shear, completed in the gaps by the shear of the start solution when
+  // there is one
+  std::vector<const double*> startE, startB, gamma1, gamma2;
+  std::vector<double*> start1, start2;
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    if (patches[p]->startE != nullptr) {
+      startE.push_back(patches[p]->startE);
+      startB.push_back(patches[p]->startB);
+      start1.push_back(estimates1[p].data());
+      start2.push_back(estimates2[p].data());
+    }
+  }
+  ks.convergenceToShear(startE.size(), startE.data(), startB.data(), start1.data(), start2.data());
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    const Patch& patch = *patches[p];
+    if (patch.startE != nullptr) {
+      for (std::size_t k = 0; k < nbPixels; ++k) {
+        if (patch.mask[k]) {
+          estimates1[p][k] = patch.gamma1[k];
+          estimates2[p][k] = patch.gamma2[k];
+        }
+      }
+    }
+    gamma1.push_back(patch.startE != nullptr ? estimates1[p].data() : patch.gamma1.data());
+    gamma2.push_back(patch.startE != nullptr ? estimates2[p].data() : patch.gamma2.data());
+  }
+  std::vector<double*> kappaE, kappaB;
+  for (Patch* patch : patches) {
+    kappaE.push_back(patch->kappa.getLayer(0));
+    kappaB.push_back(patch->kappa.getLayer(1));
+  }
+  ks.shearToConvergence(nbPatches, gamma1.data(), gamma2.data(), kappaE.data(), kappaB.data());
+
+  // The threshold decreases linearly from the largest wavelet coefficient to zero.
+  // With early stopping it does not go below the noise level, estimated on the
+  // finest scale, where the iterations converge; the patches starting from a
+  // previous solution are thresholded at the noise level from the start
+  std::vector<double> lambdaMax(nbPatches, 0.), lambdaMin(nbPatches, 0.), work;
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    starlet.transform(kappaE[p], coefficients);
+    for (std::size_t k = 0; k < (nbScales - 1) * nbPixels; ++k) {
+      lambdaMax[p] = std::max(lambdaMax[p], std::fabs(coefficients[k]));
+    }
+    if (earlyStop) {
+      work.resize(nbPixels);
+      for (std::size_t k = 0; k < nbPixels; ++k) {
+        work[k] = std::fabs(coefficients[k]);
+      }
+      std::nth_element(work.begin(), work.begin() + nbPixels / 2, work.end());
+      lambdaMin[p] = noiseThreshold * work[nbPixels / 2] / 0.6745;
+      if (patches[p]->startE != nullptr) {
+        lambdaMax[p] = lambdaMin[p];
+      }
+    }
+  }
+
+  std::vector<std::size_t> active(nbPatches);
+  for (std::size_t p = 0; p < nbPatches; ++p) {
+    active[p] = p;
+  }
+  for (int it = 0; it < m_NInpaint && !active.empty(); ++it) {
+    std::vector<double*> activeE, activeB, estimate1, estimate2;
+    for (std::size_t p : active) {
+      const std::vector<char>& mask = patches[p]->mask;
+      if (earlyStop) {
+        std::copy(kappaE[p], kappaE[p] + nbPixels, previous[p].begin());
+      }
+      double lambda = std::max(lambdaMax[p] * (1. - (it + 1.) / m_NInpaint), lambdaMin[p]);
+      starlet.transform(kappaE[p], coefficients);
+      for (int s = 0; s < nbScales - 1; ++s) {
+        Kernels::thresholdScale<EqualVarPerScale>(coefficients.data() + s * nbPixels, mask.data(), nbPixels, lambda);
+      }
+      starlet.reconstruct(coefficients, kappaE[p]);
+      Kernels::constrainBModes<ForceBMode>(kappaB[p], mask.data(), nbPixels);
+      activeE.push_back(kappaE[p]);
+      activeB.push_back(kappaB[p]);
+      estimate1.push_back(estimates1[p].data());
+      estimate2.push_back(estimates2[p].data());
+    }
+
+    // Keep the measured shear and take the estimate in the gaps
+    ks.convergenceToShear(active.size(), activeE.data(), activeB.data(), estimate1.data(), estimate2.data());
+    for (std::size_t a = 0; a < active.size(); ++a) {
+      const Patch& patch = *patches[active[a]];
+      for (std::size_t k = 0; k < nbPixels; ++k) {
+        if (patch.mask[k]) {
+          estimate1[a][k] = patch.gamma1[k];
+          estimate2[a][k] = patch.gamma2[k];
+        }
+      }
+    }
+    ks.shearToConvergence(active.size(), estimate1.data(), estimate2.data(), activeE.data(), activeB.data());
+
+    for (std::size_t p : active) {
+      ++patches[p]->iterations.inpainting;
+    }
+    if (earlyStop) {
+      active.erase(std::remove_if(active.begin(), active.end(), [&](std::size_t p) {
+        return lambdaMax[p] * (1. - (it + 1.) / m_NInpaint) <= lambdaMin[p]
+               && relativeChange(previous[p].data(), kappaE[p], nbPixels) < m_tolerance;
+      }), active.end());
+    }
+  }
+ }
+
+ void MassMapping::denoise(const Starlet& starlet, double* image, std::size_t xdim, std::size_t ydim,
+                           double sigma, double threshold) const {
+  if (sigma > 0.) {
+    gaussianSmooth(image, xdim, ydim, sigma);
+  }
+  if (threshold > 0.) {
+    std::vector<double> coefficients;
+    starlet.transform(image, coefficients);
+    fdrThreshold(coefficients, xdim * ydim, starlet.getNbScales(), threshold);
+    starlet.reconstruct(coefficients, image);
+  }
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,244 @@
+/**
+ * @file src/lib/MemoryBudgetScheduler.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/MemoryBudgetScheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#include <unistd.h>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+#include "DmModule/MassMapping.h"
+
+static Elements::Logging logger = Elements::Logging::getLogger("MemoryBudgetScheduler");
+
+namespace {
+
+const double megabyte = 1024. * 1024.;
+
+// Period of the resident memory sampling while jobs run
+const std::chrono::milliseconds samplingPeriod(20);
+
+// Limits of the correction of the estimates
+const double minCorrection = 0.25, maxCorrection = 4.;
+
+}  // namespace
+
+namespace DmModule {
+
+ std::size_t MemoryBudgetScheduler::estimatePeakMemory(Parameters& param, std::size_t nbGalaxies, unsigned nbWorkers) {
+  if (param.getPixelsize() <= 0.f) {
+    throw Elements::Exception() << "Cannot estimate the memory of a job with a pixel size of " << param.getPixelsize();
+  }
+  std::size_t side = static_cast<std::size_t>(std::max(1L, std::lround(param.getPatchWidth() / param.getPixelsize())));
+  std::size_t nbPixels = side * side;
+  std::size_t nbBinnedMaps = static_cast<std::size_t>(std::max(1, param.getnbPatches()) * std::max(1, param.getnbZBins()));
+  std::size_t nbMaps = nbBinnedMaps;
+  std::size_t nbSamples = static_cast<std::size_t>(std::max(0, param.getNSamples()));
+  std::size_t nbScales = param.getnbScales() > 0
+      ? static_cast<std::size_t>(param.getnbScales())
+      : static_cast<std::size_t>(std::max(2, static_cast<int>(std::floor(std::log2(side))) - 2));
+  std::size_t nbFftPixels = (param.get_addBorders() != 0 ? 4 : 1) * nbPixels;
+
+  // E and B convergence of every map, and their copy while the output file is written,
+  // with the mean and variance maps of the noise realizations
+  std::size_t maps = (nbSamples > 0 ? 3 : 1) * nbMaps * 2 * 2 * nbPixels * sizeof(double);
+  // Reconstruction of a batch of maps: wavelet coefficients and smoothing buffer, and
+  // for each map of the batch its shear, inpainting and convergence check buffers, its
+  // warm start and solution, mask and complex FFT buffer
+  std::size_t batch = std::min(nbMaps, MassMapping::batchSize);
+  std::size_t work = (nbScales + 2) * nbPixels * sizeof(double)
+                   + batch * (12 * nbPixels * sizeof(double) + nbPixels + nbFftPixels * 2 * sizeof(double));
+  // Noise realizations in flight, two per worker, reduced as they come: their
+  // shear and convergence maps and the working set of their reconstruction
+  std::size_t noise = 0;
+  if (nbSamples > 0) {
+    if (nbWorkers == 0) {
+      nbWorkers = std::max(1u, std::thread::hardware_concurrency());
+    }
+    std::size_t inFlight = std::min<std::size_t>(nbSamples, 2 * nbWorkers);
+    noise = inFlight * (nbMaps * 5 * nbPixels * sizeof(double) + work);
+  }
+  // Catalog columns with the redshift ranks, and the binned shear maps with their weights,
+  // and the pixels of the galaxies binned again by the noise realizations
+  std::size_t catalog = 0;
+  if (nbGalaxies > 0) {
+    catalog = nbGalaxies * (6 * sizeof(double) + sizeof(int) + sizeof(std::size_t))
+            + nbBinnedMaps * 4 * nbPixels * sizeof(double);
+    if (nbSamples > 0) {
+      catalog += nbGalaxies * 2 * sizeof(std::size_t) + nbBinnedMaps * nbPixels * sizeof(double);
+    }
+  }
+  return maps + work + noise + catalog;
+ }
+
+ std::size_t MemoryBudgetScheduler::getResidentMemory() {
+  std::ifstream statm("/proc/self/statm");
+  std::size_t size = 0, resident = 0;
+  if (!(statm >> size >> resident)) {
+    return 0;
+  }
+  return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+ }
+
+ MemoryBudgetScheduler::MemoryBudgetScheduler(std::size_t budget, unsigned nbThreads, WorkerPool::Placement placement)
+      : m_budget(budget), m_nbSlots(0), m_running(0), m_maxConcurrency(0), m_correction(1.), m_reserved(0.),
+        m_nbSubmitted(0), m_nbUnfinished(0), m_stopping(false), m_pool(nbThreads, placement) {
+  if (m_budget == 0) {
+    m_budget = static_cast<std::size_t>(0.8 * sysconf(_SC_AVPHYS_PAGES) * sysconf(_SC_PAGESIZE));
+  }
+  m_nbSlots = m_pool.getNbWorkers();
+  logger.info() << "Memory budget of " << m_budget / megabyte << " MB for at most " << m_nbSlots
+                << " concurrent jobs";
+  m_sampler = std::thread(&MemoryBudgetScheduler::samplerLoop, this);
+ }
+
+ MemoryBudgetScheduler::~MemoryBudgetScheduler() {
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this]() { return m_nbUnfinished == 0; });
+    m_stopping = true;
+  }
+  m_sample.notify_all();
+  m_sampler.join();
+ }
+
+ double MemoryBudgetScheduler::getCorrection() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_correction;
+ }
+
+ unsigned MemoryBudgetScheduler::getMaxConcurrency() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_maxConcurrency;
+ }
+
+ void MemoryBudgetScheduler::enqueue(int node, std::size_t estimate, std::function<void()> task) {
+  auto job = std::make_shared<Job>();
+  job->node = node;
+  job->order = 0;
+  job->estimate = estimate;
+  job->reserved = 0.;
+  job->measuredRatio = 0.;
+  job->startResident = 0;
+  job->task = std::move(task);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    job->order = m_nbSubmitted++;
+    ++m_nbUnfinished;
+  }
+  // Nothing is reserved until a worker takes the job: a job waiting in the queue
+  // of a busy node must not hold memory that the other nodes could use
+  if (node < 0) {
+    m_pool.submit([this, job]() { run(job); });
+  } else {
+    m_pool.submitOn(static_cast<unsigned>(node), [this, job]() { run(job); });
+  }
+ }
+
+ void MemoryBudgetScheduler::start(std::shared_ptr<Job> job) {
+  // The jobs taken by the workers start in submission order, a job larger than
+  // the budget runs alone
+  std::unique_lock<std::mutex> lock(m_mutex);
+  auto position = std::upper_bound(m_waiting.begin(), m_waiting.end(), job,
+      [](const std::shared_ptr<Job>& lhs, const std::shared_ptr<Job>& rhs) { return lhs->order < rhs->order; });
+  m_waiting.insert(position, job);
+  m_admission.wait(lock, [this, &job]() {
+    return m_waiting.front() == job && (m_running == 0 || m_reserved + job->estimate * m_correction <= m_budget);
+  });
+  m_waiting.pop_front();
+  double needed = job->estimate * m_correction;
+  if (needed > m_budget) {
+    logger.warn() << "Job needing about " << needed / megabyte << " MB exceeds the memory budget of "
+                  << m_budget / megabyte << " MB, it runs alone";
+  }
+  job->reserved = needed;
+  job->startResident = getResidentMemory();
+  m_reserved += needed;
+  m_active.push_back(job);
+  m_maxConcurrency = std::max(m_maxConcurrency, ++m_running);
+  // the next waiting job may fit as well
+  m_admission.notify_all();
+ }
+
+ void MemoryBudgetScheduler::run(std::shared_ptr<Job> job) {
+  start(job);
+  job->task();
+
+  // Last sample for the jobs shorter than the sampling period
+  std::size_t residentMemory = getResidentMemory();
+  std::lock_guard<std::mutex> lock(m_mutex);
+  record(residentMemory);
+  m_active.erase(std::find(m_active.begin(), m_active.end(), job));
+  m_reserved = std::max(0., m_reserved - job->reserved);
+  --m_running;
+  if (job->measuredRatio > 0.) {
+    m_correction = std::min(maxCorrection, std::max(minCorrection, 0.5 * (m_correction + job->measuredRatio)));
+    logger.debug() << "Job estimated at " << job->estimate / megabyte << " MB measured at " << job->measuredRatio
+                   << " times the estimate, correction of the estimates now " << m_correction;
+  }
+  m_admission.notify_all();
+  if (--m_nbUnfinished == 0) {
+    m_idle.notify_all();
+  }
+ }
+
+ void MemoryBudgetScheduler::record(std::size_t residentMemory) {
+  // The growth of the memory since a job started is shared out in proportion of
+  // the estimates of this job and of the jobs started after it, the memory of
+  // the jobs already running and the one kept by the allocator is not counted
+  if (residentMemory == 0) {
+    return;
+  }
+  std::size_t estimates = 0;
+  for (auto it = m_active.rbegin(); it != m_active.rend(); ++it) {
+    Job& job = **it;
+    estimates += job.estimate;
+    if (estimates > 0 && residentMemory > job.startResident) {
+      double ratio = static_cast<double>(residentMemory - job.startResident) / estimates;
+      job.measuredRatio = std::max(job.measuredRatio, ratio);
+    }
+  }
+ }
+
+ void MemoryBudgetScheduler::samplerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_stopping) {
+    m_sample.wait_for(lock, samplingPeriod, [this]() { return m_stopping; });
+    if (m_active.empty()) {
+      continue;
+    }
+    lock.unlock();
+    std::size_t residentMemory = getResidentMemory();
+    lock.lock();
+    record(residentMemory);
+  }
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,197 @@
+/**
+ * @file src/lib/NoiseResampler.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/NoiseResampler.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <deque>
+#include <future>
+#include <memory>
+
+#include "ElementsKernel/Logging.h"
+
+static Elements::Logging logger = Elements::Logging::getLogger("NoiseResampler");
+
+namespace {
+
+/*
+ * Philox4x32-10 counter-based generator (Salmon et al. 2011): ten rounds of
+ * multiplications of the counter mixed with a key bumped by Weyl constants
+ */
+std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) {
+  for (int round = 0; round < 10; ++round) {
+    std::uint64_t product0 = 0xD2511F53ull * counter[0];
+    std::uint64_t product1 = 0xCD9E8D57ull * counter[2];
+    counter = {{static_cast<std::uint32_t>(product1 >> 32) ^ counter[1] ^ key[0],
+                static_cast<std::uint32_t>(product1),
+                static_cast<std::uint32_t>(product0 >> 32) ^ counter[3] ^ key[1],
+                static_cast<std::uint32_t>(product0)}};
+    key[0] += 0x9E3779B9u;
+    key[1] += 0xBB67AE85u;
+  }
+  return counter;
+}
+
+/*
+ * Angle in [0, 2 pi[ of the rotation of the shear of a galaxy in a realization
+ */
+double rotationAngle(std::uint64_t seed, std::uint64_t realization, std::uint64_t galaxy) {
+  std::array<std::uint32_t, 4> random = philox(
+      {{static_cast<std::uint32_t>(galaxy), static_cast<std::uint32_t>(galaxy >> 32),
+        static_cast<std::uint32_t>(realization), static_cast<std::uint32_t>(realization >> 32)}},
+      {{static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)}});
+  // the 53 high bits of the first 64 random bits
+  std::uint64_t bits = (static_cast<std::uint64_t>(random[0]) << 32 | random[1]) >> 11;
+  return 2. * M_PI * std::ldexp(static_cast<double>(bits), -53);
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ NoiseResampler::NoiseResampler(Parameters& param, const ShearCatalog& catalog, std::uint64_t seed)
+      : m_catalog(catalog), m_massMapping(param), m_footprint(MapMaker(param).makeFootprint(catalog)),
+        m_nbZBins(static_cast<std::size_t>(std::max(1, param.getnbZBins()))), m_seed(seed), m_nbSamples(param.getNSamples()) {
+  // The weights of the pixels do not change with the rotations
+  std::size_t nbMapPixels = m_footprint.maps.empty() ? 0 : m_footprint.maps.front().getNbPixels();
+  m_weightSums.assign(m_footprint.maps.size() * nbMapPixels, 0.);
+  const std::vector<double>& weight = catalog.getWeight();
+  for (std::size_t e = 0; e < m_footprint.galaxies.size(); ++e) {
+    m_weightSums[m_footprint.pixels[e]] += weight[m_footprint.galaxies[e]];
+  }
+ }
+
+ std::vector<PatchMap> NoiseResampler::makeRealization(std::uint64_t index) const {
+  auto shearMaps = m_buffers.acquire(0, [this]() {
+    return std::unique_ptr<std::vector<PatchMap>>(new std::vector<PatchMap>(m_footprint.maps));
+  });
+  binRealization(index, *shearMaps);
+  return m_massMapping.reconstruct(*shearMaps, nullptr, m_nbZBins);
+ }
+
+ NoiseResampler::Statistics NoiseResampler::resample(WorkerPool& pool) const {
+  return resample(m_nbSamples, pool);
+ }
+
+ NoiseResampler::Statistics NoiseResampler::resample(int nbRealizations, WorkerPool& pool) const {
+  logger.info() << "Making " << nbRealizations << " noise realizations of " << m_footprint.maps.size()
+                << " maps on " << pool.getNbWorkers() << " workers";
+  Statistics statistics {{}, {}, 0};
+
+  // The realizations are reduced in their order, the next ones are made meanwhile
+  std::size_t window = 2 * std::max(1u, pool.getNbWorkers());
+  std::deque<std::future<std::vector<PatchMap>>> inFlight;
+  int next = 0;
+  try {
+    while (statistics.nbRealizations < nbRealizations) {
+      while (next < nbRealizations && inFlight.size() < window) {
+        std::uint64_t index = static_cast<std::uint64_t>(next++);
+        inFlight.push_back(pool.submit([this, index]() { return makeRealization(index); }));
+      }
+      std::vector<PatchMap> realization = inFlight.front().get();
+      inFlight.pop_front();
+
+      // Welford update of the mean and of the sum of the squared deviations
+      if (statistics.nbRealizations == 0) {
+        for (const auto& kappa : realization) {
+          statistics.mean.emplace_back(kappa.getXdim(), kappa.getYdim(), kappa.getNbLayers(), kappa.getPixelSize(),
+                                       kappa.getCenterX(), kappa.getCenterY());
+          statistics.variance.push_back(statistics.mean.back());
+        }
+      }
+      double n = ++statistics.nbRealizations;
+      for (std::size_t m = 0; m < realization.size(); ++m) {
+        const double* kappa = realization[m].getLayer(0);
+        double* mean = statistics.mean[m].getLayer(0);
+        double* squares = statistics.variance[m].getLayer(0);
+        std::size_t size = realization[m].getNbPixels() * realization[m].getNbLayers();
+        for (std::size_t k = 0; k < size; ++k) {
+          double delta = kappa[k] - mean[k];
+          mean[k] += delta / n;
+          squares[k] += delta * (kappa[k] - mean[k]);
+        }
+      }
+    }
+  } catch (...) {
+    // the realizations in flight use the resampler
+    for (auto& realization : inFlight) {
+      realization.wait();
+    }
+    throw;
+  }
+
+  if (statistics.nbRealizations > 1) {
+    for (auto& variance : statistics.variance) {
+      double* squares = variance.getLayer(0);
+      std::size_t size = variance.getNbPixels() * variance.getNbLayers();
+      for (std::size_t k = 0; k < size; ++k) {
+        squares[k] /= statistics.nbRealizations - 1;
+      }
+    }
+  }
+  logger.info() << "Reduced " << statistics.nbRealizations << " noise realizations with "
+                << getNbBuffers() << " shear map buffers";
+  return statistics;
+ }
+
+ void NoiseResampler::binRealization(std::uint64_t index, std::vector<PatchMap>& shearMaps) const {
+  if (shearMaps.empty()) {
+    return;
+  }
+  std::size_t nbMapPixels = shearMaps.front().getNbPixels();
+  for (auto& map : shearMaps) {
+    std::fill(map.getLayer(0), map.getLayer(0) + nbMapPixels, 0.);
+    std::fill(map.getLayer(1), map.getLayer(1) + nbMapPixels, 0.);
+  }
+
+  // The galaxy keeps its weight and the modulus of its shear, the number of
+  // galaxies of the pixels is the one of the footprint
+  const std::vector<double>& gamma1 = m_catalog.getGamma1();
+  const std::vector<double>& gamma2 = m_catalog.getGamma2();
+  const std::vector<double>& weight = m_catalog.getWeight();
+  for (std::size_t e = 0; e < m_footprint.galaxies.size(); ++e) {
+    std::size_t i = m_footprint.galaxies[e];
+    double angle = rotationAngle(m_seed, index, i);
+    double c = std::cos(angle), s = std::sin(angle);
+    PatchMap& map = shearMaps[m_footprint.pixels[e] / nbMapPixels];
+    std::size_t k = m_footprint.pixels[e] % nbMapPixels;
+    map.getLayer(0)[k] += weight[i] * (gamma1[i] * c - gamma2[i] * s);
+    map.getLayer(1)[k] += weight[i] * (gamma1[i] * s + gamma2[i] * c);
+  }
+
+  for (std::size_t m = 0; m < shearMaps.size(); ++m) {
+    double* g1 = shearMaps[m].getLayer(0);
+    double* g2 = shearMaps[m].getLayer(1);
+    const double* sums = m_weightSums.data() + m * nbMapPixels;
+    for (std::size_t k = 0; k < nbMapPixels; ++k) {
+      if (sums[k] > 0.) {
+        g1[k] /= sums[k];
+        g2[k] /= sums[k];
+      }
+    }
+  }
+ }
+
+}  // namespace DmModule
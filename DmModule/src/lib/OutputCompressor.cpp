@@ -0,0 +1,280 @@
+/**
+ * @file src/lib/OutputCompressor.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/OutputCompressor.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <future>
+#include <memory>
+
+#include <boost/algorithm/string.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("OutputCompressor");
+
+namespace {
+
+/*
+ * FITS file in memory, CFITSIO keeps the addresses of buffer and size to grow the buffer
+ */
+struct MemoryFits {
+  MemoryFits() : fptr(nullptr), buffer(nullptr), size(0), status(0) {
+    fits_create_memfile(&fptr, &buffer, &size, 0, std::realloc, &status);
+  }
+  ~MemoryFits() {
+    int close_status = 0;
+    if (fptr != nullptr) {
+      fits_close_file(fptr, &close_status);
+    }
+    std::free(buffer);
+  }
+  fitsfile* fptr;
+  void* buffer;
+  std::size_t size;
+  int status;
+};
+
+int fitsCompressionType(DmModule::OutputCompressor::Format format) {
+  switch (format) {
+  case DmModule::OutputCompressor::Format::RICE:
+    return RICE_1;
+  case DmModule::OutputCompressor::Format::GZIP:
+    return GZIP_2;
+  default:
+    return NOCOMPRESS;
+  }
+}
+
+// One tile per layer, GZIP_2 without quantization of the pixel values is lossless. CFITSIO
+// compresses floating point pixels losslessly with GZIP only: RICE_1 quantizes them
+void setCompression(fitsfile* fptr, int type, long xdim, long ydim, int* status) {
+  long tile[3] = {xdim, ydim, 1};
+  fits_set_compression_type(fptr, type, status);
+  fits_set_tile_dim(fptr, 3, tile, status);
+  if (type == GZIP_2) {
+    fits_set_quantize_level(fptr, 0.f, status);
+  }
+}
+
+// Records in the header of the current HDU whether its pixel values were quantized
+void writeLossy(fitsfile* fptr, int type, int* status) {
+  int lossy = type == RICE_1 ? 1 : 0;
+  fits_write_key(fptr, TLOGICAL, "LOSSY", &lossy,
+                 lossy ? "Pixel values quantized by the RICE_1 compression" : "Lossless compression", status);
+}
+
+void checkStatus(int status, const fs::path& filename) {
+  if (status != 0) {
+    char message[FLEN_STATUS];
+    fits_get_errstatus(status, message);
+    throw Elements::Exception() << "Cannot write compressed FITS file " << filename << ": " << message;
+  }
+}
+
+/*
+ * Runs task(i) for every part on the pool, or in the calling thread when CFITSIO
+ * is not built to be used by several threads
+ */
+template <typename Task>
+void runParts(DmModule::WorkerPool& pool, std::size_t nbParts, const Task& task) {
+  if (!fits_is_reentrant()) {
+    for (std::size_t i = 0; i < nbParts; ++i) {
+      task(i);
+    }
+    return;
+  }
+  std::vector<std::future<void>> done;
+  for (std::size_t i = 0; i < nbParts; ++i) {
+    done.push_back(pool.submit([&task, i]() { task(i); }));
+  }
+  for (auto& part : done) {
+    part.wait();
+  }
+  for (auto& part : done) {
+    part.get();
+  }
+}
+
+/*
+ * Writes the file from the current HDU of the parts, in order. A null primary
+ * array is created unless the first part is the primary HDU of the file.
+ */
+void assemble(const fs::path& filename, const std::vector<std::unique_ptr<MemoryFits>>& parts,
+              bool firstIsPrimary) {
+  fitsfile* fptr = nullptr;
+  int status = 0;
+  for (const auto& part : parts) {
+    checkStatus(part->status, filename);
+  }
+  fits_create_file(&fptr, ("!" + filename.string()).c_str(), &status);
+  if (!firstIsPrimary) {
+    fits_create_img(fptr, BYTE_IMG, 0, nullptr, &status);
+  }
+  for (const auto& part : parts) {
+    fits_copy_hdu(part->fptr, fptr, 0, &status);
+  }
+  int close_status = 0;
+  if (fptr != nullptr) {
+    fits_close_file(fptr, &close_status);
+  }
+  checkStatus(status != 0 ? status : close_status, filename);
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ OutputCompressor::Format OutputCompressor::parseFormat(const std::string& name) {
+  std::string format = boost::to_lower_copy(boost::trim_copy(name));
+  if (format.empty() || format == "none") {
+    return Format::NONE;
+  }
+  if (format == "rice") {
+    return Format::RICE;
+  }
+  if (format == "gzip") {
+    return Format::GZIP;
+  }
+  throw Elements::Exception() << "Unknown compression \"" << name << "\", expected none, rice or gzip";
+ }
+
+ OutputCompressor::OutputCompressor(Format format, unsigned nbThreads)
+      : m_format(format), m_pool(format == Format::NONE ? 1 : nbThreads) {
+ }
+
+ std::string OutputCompressor::getMapFormat() const {
+  switch (m_format) {
+  case Format::RICE:
+    return "RICE_1";
+  case Format::GZIP:
+    return "GZIP_2";
+  default:
+    return "NONE";
+  }
+ }
+
+ fs::path OutputCompressor::getMapFilename(const fs::path& filename) const {
+  return m_format == Format::NONE ? filename : fs::path(filename.string() + ".fz");
+ }
+
+ fs::path OutputCompressor::writeMaps(const fs::path& filename, const std::vector<PatchMap>& maps) {
+  fs::path output = getMapFilename(filename);
+  writeMapFile(output, maps);
+  return output;
+ }
+
+ void OutputCompressor::writeMapFile(const fs::path& output, const std::vector<PatchMap>& maps) {
+  if (m_format == Format::NONE) {
+    PatchMap::writeFits(output, maps);
+    return;
+  }
+
+  logger.info() << "Writing " << maps.size() << " " << getMapFormat() << " tile compressed maps in FITS file "
+                << output << " ...";
+
+  int type = fitsCompressionType(m_format);
+  std::vector<std::unique_ptr<MemoryFits>> parts;
+  for (std::size_t i = 0; i < maps.size(); ++i) {
+    parts.emplace_back(new MemoryFits());
+  }
+  runParts(m_pool, maps.size(), [&parts, &maps, type](std::size_t i) {
+    MemoryFits& part = *parts[i];
+    fits_create_img(part.fptr, BYTE_IMG, 0, nullptr, &part.status);
+    setCompression(part.fptr, type, static_cast<long>(maps[i].getXdim()), static_cast<long>(maps[i].getYdim()),
+                   &part.status);
+    maps[i].writeFitsHdu(part.fptr, &part.status);
+    writeLossy(part.fptr, type, &part.status);
+  });
+  assemble(output, parts, false);
+ }
+
+ fs::path OutputCompressor::compressFits(const fs::path& filename) {
+  if (m_format == Format::NONE) {
+    return filename;
+  }
+
+  fs::path compressed = getMapFilename(filename);
+  logger.info() << "Compressing FITS file " << filename << " to " << compressed << " (" << getMapFormat() << ")";
+
+  // Geometry of the HDUs, read once so that every part opens its own handle
+  fitsfile* fptr = nullptr;
+  int status = 0, nbHdus = 0;
+  std::vector<int> naxis;
+  std::vector<std::vector<long>> naxes;
+  fits_open_file(&fptr, filename.string().c_str(), READONLY, &status);
+  fits_get_num_hdus(fptr, &nbHdus, &status);
+  for (int hdu = 1; hdu <= nbHdus && status == 0; ++hdu) {
+    int type = IMAGE_HDU, dims = 0;
+    std::vector<long> sizes(3, 1);
+    fits_movabs_hdu(fptr, hdu, &type, &status);
+    if (type == IMAGE_HDU) {
+      fits_get_img_dim(fptr, &dims, &status);
+      fits_get_img_size(fptr, std::min(dims, 3), sizes.data(), &status);
+    }
+    naxis.push_back(type == IMAGE_HDU ? dims : -1);
+    naxes.push_back(sizes);
+  }
+  int close_status = 0;
+  if (fptr != nullptr) {
+    fits_close_file(fptr, &close_status);
+  }
+  checkStatus(status, filename);
+
+  // A null primary array is copied as it is, the tables are copied without
+  // compression and the images are compressed
+  int type = fitsCompressionType(m_format);
+  bool nullPrimary = !naxis.empty() && naxis[0] == 0;
+  std::vector<std::unique_ptr<MemoryFits>> parts;
+  for (std::size_t i = 0; i < naxis.size(); ++i) {
+    parts.emplace_back(new MemoryFits());
+  }
+  runParts(m_pool, parts.size(), [&parts, &naxis, &naxes, &filename, type, nullPrimary](std::size_t i) {
+    MemoryFits& part = *parts[i];
+    fitsfile* source = nullptr;
+    fits_open_file(&source, filename.string().c_str(), READONLY, &part.status);
+    fits_movabs_hdu(source, static_cast<int>(i) + 1, nullptr, &part.status);
+    if (!(i == 0 && nullPrimary)) {
+      fits_create_img(part.fptr, BYTE_IMG, 0, nullptr, &part.status);
+    }
+    if (naxis[i] > 0) {
+      setCompression(part.fptr, type, naxes[i][0], naxes[i][1], &part.status);
+    }
+    fits_copy_hdu(source, part.fptr, 0, &part.status);
+    if (naxis[i] > 0) {
+      writeLossy(part.fptr, type, &part.status);
+    }
+    int source_status = 0;
+    if (source != nullptr) {
+      fits_close_file(source, &source_status);
+    }
+  });
+  assemble(compressed, parts, nullPrimary);
+  fs::remove(filename);
+  return compressed;
+ }
+
+}  // namespace DmModule
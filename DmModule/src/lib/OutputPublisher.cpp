@@ -0,0 +1,262 @@
+/**
+ * @file src/lib/OutputPublisher.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/OutputPublisher.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("OutputPublisher");
+
+namespace {
+
+void writeFile(const fs::path& filename, const std::string& content) {
+  int fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw Elements::Exception() << "Cannot create " << filename << ": " << std::strerror(errno);
+  }
+  const char* data = content.data();
+  std::size_t left = content.size();
+  while (left > 0) {
+    ssize_t written = ::write(fd, data, left);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      int error = errno;
+      ::close(fd);
+      throw Elements::Exception() << "Cannot write " << filename << ": " << std::strerror(error);
+    }
+    data += written;
+    left -= static_cast<std::size_t>(written);
+  }
+  if (::close(fd) != 0) {
+    throw Elements::Exception() << "Cannot close " << filename << ": " << std::strerror(errno);
+  }
+}
+
+// Some file systems do not sync directories and return EINVAL
+void syncPath(const fs::path& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw Elements::Exception() << "Cannot open " << path << " to sync it: " << std::strerror(errno);
+  }
+  int error = ::fsync(fd) == 0 ? 0 : errno;
+  ::close(fd);
+  if (error != 0 && error != EINVAL) {
+    throw Elements::Exception() << "Cannot sync " << path << ": " << std::strerror(error);
+  }
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ OutputPublisher::OutputPublisher(unsigned nbThreads, std::chrono::milliseconds maxLatency, std::size_t maxBatch)
+      : m_maxLatency(maxLatency), m_maxBatch(std::max<std::size_t>(maxBatch, 1)), m_writing(0),
+        m_nbGroupCommits(0), m_flushing(0), m_committing(false), m_stopping(false), m_pool(nbThreads) {
+  m_committer = std::thread(&OutputPublisher::committerLoop, this);
+ }
+
+ OutputPublisher::~OutputPublisher() {
+  try {
+    flush();
+  } catch (const std::exception& e) {
+    logger.error() << e.what();
+  }
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_cond.notify_all();
+  m_committer.join();
+ }
+
+ fs::path OutputPublisher::getStagingPath(const fs::path& filename) {
+  return filename.parent_path() / fs::unique_path("." + filename.filename().string() + ".%%%%%%%%.part");
+ }
+
+ std::future<void> OutputPublisher::publish(const fs::path& filename, std::string content) {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> result = done->get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_writing;
+  }
+
+  fs::path staged = getStagingPath(filename);
+  auto data = std::make_shared<std::string>(std::move(content));
+  m_pool.submit([this, staged, filename, done, data]() {
+    try {
+      writeFile(staged, *data);
+    } catch (const std::exception& e) {
+      boost::system::error_code ignored;
+      fs::remove(staged, ignored);
+      {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        --m_writing;
+      }
+      fail(done, e.what());
+      return;
+    }
+    stage(Staged{staged, filename, done, std::chrono::steady_clock::now()});
+  });
+  return result;
+ }
+
+ std::future<void> OutputPublisher::publishFile(const fs::path& staged, const fs::path& filename) {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> result = done->get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_writing;
+  }
+  stage(Staged{staged, filename, done, std::chrono::steady_clock::now()});
+  return result;
+ }
+
+ void OutputPublisher::flush() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  ++m_flushing;
+  m_cond.notify_all();
+  m_idle.wait(lock, [this]() { return m_writing == 0 && m_ready.empty() && !m_committing; });
+  --m_flushing;
+  if (!m_errors.empty()) {
+    std::vector<std::string> errors;
+    errors.swap(m_errors);
+    throw Elements::Exception() << errors.size() << " outputs could not be published, first error: "
+                                << errors.front();
+  }
+ }
+
+ std::size_t OutputPublisher::getNbGroupCommits() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nbGroupCommits;
+ }
+
+ void OutputPublisher::stage(Staged output) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    --m_writing;
+    m_ready.push_back(std::move(output));
+  }
+  m_cond.notify_all();
+ }
+
+ void OutputPublisher::fail(const std::shared_ptr<std::promise<void>>& done, const std::string& message) {
+  done->set_exception(std::make_exception_ptr(Elements::Exception() << message));
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_errors.push_back(message);
+  }
+  m_idle.notify_all();
+ }
+
+ void OutputPublisher::committerLoop() {
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_cond.wait(lock, [this]() { return m_stopping || !m_ready.empty(); });
+    if (m_ready.empty()) {
+      return;
+    }
+
+    // Gather outputs until the group is full, the oldest one reaches the latency
+    // target or somebody waits for the outputs
+    auto deadline = m_ready.front().ready + m_maxLatency;
+    m_cond.wait_until(lock, deadline, [this]() {
+      return m_stopping || m_flushing > 0 || m_ready.size() >= m_maxBatch;
+    });
+
+    std::size_t size = std::min(m_ready.size(), m_maxBatch);
+    std::vector<Staged> group(std::make_move_iterator(m_ready.begin()),
+                              std::make_move_iterator(m_ready.begin() + size));
+    m_ready.erase(m_ready.begin(), m_ready.begin() + size);
+    m_committing = true;
+    lock.unlock();
+
+    commit(group);
+
+    lock.lock();
+    m_committing = false;
+    ++m_nbGroupCommits;
+    m_idle.notify_all();
+  }
+ }
+
+ void OutputPublisher::commit(std::vector<Staged>& group) {
+  logger.debug() << "Committing a group of " << group.size() << " outputs";
+
+  // The data of the files is synced concurrently
+  std::vector<std::future<void>> synced;
+  for (const auto& output : group) {
+    fs::path staged = output.staged;
+    synced.push_back(m_pool.submit([staged]() { syncPath(staged); }));
+  }
+  for (auto& sync : synced) {
+    sync.wait();
+  }
+
+  // The renames are atomic, readers see either no file or the complete one
+  std::vector<std::string> errors(group.size());
+  std::set<fs::path> directories;
+  for (std::size_t i = 0; i < group.size(); ++i) {
+    try {
+      synced[i].get();
+      fs::rename(group[i].staged, group[i].target);
+      directories.insert(group[i].target.has_parent_path() ? group[i].target.parent_path() : fs::path("."));
+    } catch (const std::exception& e) {
+      errors[i] = e.what();
+      boost::system::error_code ignored;
+      fs::remove(group[i].staged, ignored);
+    }
+  }
+
+  // One sync per directory makes the renames of the whole group durable
+  for (const auto& directory : directories) {
+    try {
+      syncPath(directory);
+    } catch (const std::exception& e) {
+      logger.warn() << e.what();
+    }
+  }
+
+  for (std::size_t i = 0; i < group.size(); ++i) {
+    if (errors[i].empty()) {
+      group[i].done->set_value();
+    } else {
+      fail(group[i].done, "Cannot publish " + group[i].target.string() + ": " + errors[i]);
+    }
+  }
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,243 @@
+/**
+ * @file src/lib/ParameterSweep.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/ParameterSweep.h"
+
+#include <algorithm>
+#include <future>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <utility>
+
+#include <boost/algorithm/string.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+#include "DmModule/DmOutput.h"
+#include "DmModule/MapMaker.h"
+#include "DmModule/MassMapping.h"
+#include "DmModule/MemoryBudgetScheduler.h"
+#include "DmModule/OutputPublisher.h"
+#include "DmModule/PatchMap.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("ParameterSweep");
+
+namespace {
+
+// Parameters which can be swept without binning the catalog again
+const std::vector<std::string> sweepable {"sigmaGauss", "thresholdFDR", "NInpaint", "nbScales", "RSsigmaGauss"};
+
+std::vector<std::pair<std::string, std::vector<double>>> parseGrid(const std::string& grid) {
+  std::vector<std::pair<std::string, std::vector<double>>> axes;
+  std::vector<std::string> items;
+  boost::split(items, grid, boost::is_any_of(";"));
+  for (auto& item : items) {
+    boost::trim(item);
+    if (item.empty()) {
+      continue;
+    }
+    std::size_t equal = item.find('=');
+    std::string name = boost::trim_copy(item.substr(0, equal));
+    if (equal == std::string::npos || std::find(sweepable.begin(), sweepable.end(), name) == sweepable.end()) {
+      throw Elements::Exception() << "Invalid sweep grid entry \"" << item
+                                  << "\", expected name=v1,v2,... with name in " << boost::join(sweepable, ", ");
+    }
+    std::vector<std::string> fields;
+    std::vector<double> values;
+    boost::split(fields, item.substr(equal + 1), boost::is_any_of(","));
+    for (const auto& field : fields) {
+      try {
+        values.push_back(std::stod(field));
+      } catch (const std::exception&) {
+        throw Elements::Exception() << "Invalid value \"" << field << "\" for " << name << " in the sweep grid";
+      }
+    }
+    axes.emplace_back(name, values);
+  }
+  if (axes.empty()) {
+    throw Elements::Exception() << "Empty sweep grid";
+  }
+  return axes;
+}
+
+DmModule::Parameters makeVariant(DmModule::Parameters& base, const std::map<std::string, double>& values) {
+  auto value = [&values](const std::string& name, double fallback) {
+    auto it = values.find(name);
+    return it == values.end() ? fallback : it->second;
+  };
+  // the constructor takes the pixel size in arcminutes, the sweep does not make
+  // noise realizations
+  DmModule::Parameters variant(base.getNItReducedShear(), base.getnbPatches(), base.getPixelsize() * 60.f,
+      base.getPatchWidth(), base.getMapCenterX(), base.getMapCenterY(), base.getnbZBins(), base.getZMin(),
+      base.getZMax(), base.get_BalancedBins(), static_cast<int>(value("NInpaint", base.getNInpaint())),
+      base.getEqualVarPerScale(), base.getForceBMode(), static_cast<int>(value("nbScales", base.getnbScales())),
+      base.get_addBorders(), static_cast<float>(value("RSsigmaGauss", base.getRSSigmaGauss())),
+      static_cast<float>(value("sigmaGauss", base.getSigmaGauss())), 0, base.getRSThreshold(),
+      static_cast<float>(value("thresholdFDR", base.getThreshold())));
+  variant.setConvergenceTolerance(base.getConvergenceTolerance());
+  return variant;
+}
+
+// The tasks use the locals of run: all the submitted ones must be done before an
+// error is rethrown and the locals are destroyed, on every way out of run
+template <typename T>
+void waitAll(std::vector<std::future<T>>& futures) {
+  for (auto& future : futures) {
+    future.wait();
+  }
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ ParameterSweep::ParameterSweep(Parameters& base, const std::string& grid): m_base(base) {
+  auto axes = parseGrid(grid);
+
+  // odometer over the values of all the axes, the last axis varying fastest
+  std::vector<std::size_t> position(axes.size(), 0);
+  for (;;) {
+    std::map<std::string, double> values;
+    std::ostringstream label;
+    for (std::size_t a = 0; a < axes.size(); ++a) {
+      values[axes[a].first] = axes[a].second[position[a]];
+      label << (a > 0 ? " " : "") << axes[a].first << "=" << axes[a].second[position[a]];
+    }
+    m_points.push_back(makeVariant(m_base, values));
+    m_labels.push_back(label.str());
+
+    std::size_t a = axes.size();
+    while (a > 0 && ++position[a - 1] == axes[a - 1].second.size()) {
+      position[--a] = 0;
+    }
+    if (a == 0) {
+      break;
+    }
+  }
+  logger.info() << "Parameter sweep over " << m_points.size() << " grid points";
+ }
+
+ std::vector<fs::path> ParameterSweep::run(const ShearCatalog& catalog, const fs::path& workdir,
+                                           const fs::path& out_xml_file, unsigned nbThreads,
+                                           OutputCompressor::Format compression, std::size_t memoryBudget,
+                                           WorkerPool::Placement placement, unsigned nbOutputThreads) {
+  // The binning only depends on parameters which are not swept
+  logger.info() << "Binning " << catalog.getNbGalaxies() << " galaxies, estimated peak memory "
+                << MemoryBudgetScheduler::estimatePeakMemory(m_points.front(), catalog.getNbGalaxies(), nbThreads)
+                   / (1024 * 1024) << " MB";
+  MapMaker mapMaker(m_base);
+  const std::vector<PatchMap> shearMaps = mapMaker.makeShearMaps(catalog);
+  std::size_t nbZBins = mapMaker.getZEdges().size() - 1;
+
+  // Every grid point is checked before anything is submitted
+  std::vector<std::size_t> estimates;
+  for (auto& point : m_points) {
+    estimates.push_back(MemoryBudgetScheduler::estimatePeakMemory(point, 0, nbThreads));
+  }
+
+  // The output threads mostly wait for the file system, a few of them are enough
+  // next to the reconstruction workers
+  nbOutputThreads = std::max(nbOutputThreads, 1u);
+  MemoryBudgetScheduler scheduler(memoryBudget, nbThreads, placement);
+  OutputCompressor compressor(compression, nbOutputThreads);
+  OutputPublisher publisher(nbOutputThreads);
+  logger.info() << "Reconstructing " << m_points.size() << " grid points within "
+                << scheduler.getBudget() / (1024 * 1024) << " MB on " << scheduler.getNbNodes() << " nodes";
+
+  // Copy of the shear maps made, and so first touched, on each node
+  std::size_t mapsSize = 0;
+  for (const auto& shearMap : shearMaps) {
+    mapsSize += shearMap.getNbPixels() * shearMap.getNbLayers() * sizeof(double);
+  }
+  std::vector<std::vector<PatchMap>> replicas(scheduler.getNbNodes() > 1 ? scheduler.getNbNodes() : 0);
+  std::vector<std::future<void>> copies;
+  try {
+    for (unsigned node = 0; node < replicas.size(); ++node) {
+      copies.push_back(scheduler.submitOn(node, mapsSize, [&replicas, &shearMaps, node]() {
+        replicas[node] = shearMaps;
+      }));
+    }
+  } catch (...) {
+    waitAll(copies);
+    throw;
+  }
+  waitAll(copies);
+  for (auto& copy : copies) {
+    copy.get();
+  }
+
+  std::vector<std::future<fs::path>> results;
+  try {
+    for (std::size_t i = 0; i < m_points.size(); ++i) {
+      std::ostringstream suffix;
+      suffix << "_" << std::setw(4) << std::setfill('0') << i;
+      fs::path xml_file = out_xml_file.parent_path() / (out_xml_file.stem().string() + suffix.str() + ".xml");
+      fs::path fits_file = out_xml_file.stem().string() + suffix.str() + ".fits";
+      logger.info() << "Grid point " << i << " (" << m_labels[i] << ") -> " << xml_file;
+
+      // all the patches of a product are reconstructed by the same task, so on one node
+      unsigned node = static_cast<unsigned>(i % scheduler.getNbNodes());
+      const std::vector<PatchMap>& nodeShearMaps = replicas.empty() ? shearMaps : replicas[node];
+      results.push_back(scheduler.submitOn(node, estimates[i], [this, i, &nodeShearMaps, &compressor, &publisher,
+                                                                workdir, xml_file, fits_file, nbZBins]() {
+        MassMapping massMapping(m_points[i]);
+        std::vector<MassMapping::Iterations> iterations;
+        std::vector<PatchMap> convergenceMaps = massMapping.reconstruct(nodeShearMaps, &iterations, nbZBins);
+        int nbInpaint = 0, nbReducedShear = 0;
+        for (const auto& patch : iterations) {
+          nbInpaint += patch.inpainting;
+          nbReducedShear += patch.reducedShear;
+        }
+        logger.info() << "Grid point " << i << ": " << nbInpaint << " inpainting iterations and " << nbReducedShear
+                      << " reduced shear corrections over " << iterations.size() << " maps, at most "
+                      << iterations.size() * m_points[i].getNInpaint() * (m_points[i].getNItReducedShear() + 1)
+                      << " and " << iterations.size() * m_points[i].getNItReducedShear();
+        // The maps and the product are published together in the group commits
+        fs::path maps_file = compressor.getMapFilename(workdir / "data" / fits_file);
+        fs::path staged = OutputPublisher::getStagingPath(maps_file);
+        compressor.writeMapFile(staged, convergenceMaps);
+        publisher.publishFile(staged, maps_file);
+        DmOutput::createOutputXml(workdir / xml_file, maps_file.filename(), publisher);
+        return workdir / xml_file;
+      }));
+    }
+  } catch (...) {
+    waitAll(results);
+    throw;
+  }
+
+  waitAll(results);
+  std::vector<fs::path> products;
+  for (auto& result : results) {
+    products.push_back(result.get());
+  }
+  publisher.flush();
+  logger.info() << "At most " << scheduler.getMaxConcurrency() << " grid points ran at the same time, "
+                << "measured memory " << scheduler.getCorrection() << " times the estimates";
+  return products;
+ }
+
+}  // namespace DmModule
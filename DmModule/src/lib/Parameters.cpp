@@ -23,6 +23,13 @@
 
 #include "DmModule/Parameters.h"
 
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+#include "ElementsKernel/Exception.h"
+
 static Elements::Logging logger = Elements::Logging::getLogger("Parameters");
 
 namespace DmModule {
@@ -30,18 +37,20 @@ namespace DmModule {
  Parameters::Parameters():m_NItReducedShear(10), m_nbPatches(1), m_PixelSize( 0.586/60.), m_PatchWidth(10.),
            mapCenterX(0.), mapCenterY(0.), m_nbZBins(1), m_zMin(0.), m_zMax(10.), m_balancedBin(0),
            m_NInpaint(100), m_EqualVarPerScale(0), m_ForceBMode(1), m_nbScales(0), m_add_borders(0),
-           m_sigmaGauss(0.), m_thresholdFDR(0.), m_nbSamples(0), m_RSsigmaGauss(0.), m_RSthresholdFDR(0.)
+           m_sigmaGauss(0.), m_thresholdFDR(0.), m_nbSamples(0), m_RSsigmaGauss(0.), m_RSthresholdFDR(0.),
+           m_convergenceTolerance(0.)
  { }
 
  Parameters::Parameters(int NItReducedShear, int NPatches, float PixelSize, float PatchWidth, std::vector<double> mapCenterX,
           std::vector<double> mapCenterY, int nbZBins, std::vector<double> zMin, double zMax, long BalancedBins,
           int NInpaint, long EqualVarPerScale, long ForceBMode, int nbScales, long add_borders, float RSsigmaGauss,
           float sigmaGauss, int nbSamples, float RSthresholdFDR, float thresholdFDR): m_NItReducedShear(NItReducedShear), m_nbPatches(NPatches),
-           m_PixelSize(PixelSize/60.), m_PatchWidth(10.), mapCenterX(mapCenterX), mapCenterY(mapCenterY),
-           m_nbZBins(nbZBins), m_zMin(zMin), m_zMax(zMax), m_balancedBin(BalancedBins),
+           m_PixelSize(PixelSize/60.), m_PatchWidth(PatchWidth), mapCenterX(std::move(mapCenterX)),
+           mapCenterY(std::move(mapCenterY)), m_nbZBins(nbZBins), m_zMin(std::move(zMin)), m_zMax(zMax), m_balancedBin(BalancedBins),
            m_NInpaint(NInpaint), m_EqualVarPerScale(EqualVarPerScale), m_ForceBMode(ForceBMode),
            m_nbScales(nbScales), m_add_borders(add_borders), m_RSsigmaGauss(RSsigmaGauss), m_sigmaGauss(sigmaGauss),
-           m_thresholdFDR(thresholdFDR), m_RSthresholdFDR(RSthresholdFDR), m_nbSamples(nbSamples) { }
+           m_thresholdFDR(thresholdFDR), m_RSthresholdFDR(RSthresholdFDR), m_nbSamples(nbSamples),
+           m_convergenceTolerance(0.) { }
 
  Parameters Parameters::readParameterFile (const boost::filesystem::path& parameter_file){
   logger.info() << "Getting information from input Parameter XML file " << parameter_file << " ...";
@@ -87,12 +96,55 @@ namespace DmModule {
     //
     logger.warn() << "TODO: Log the values of the elements";
 
- return Parameters(m_NItReducedShear, m_nbPatches, m_PixelSize, m_PatchWidth, mapCenterX, mapCenterY, m_nbZBins,
+ Parameters param(m_NItReducedShear, m_nbPatches, m_PixelSize, m_PatchWidth, mapCenterX, mapCenterY, m_nbZBins,
             m_zMin, m_zMax, m_balancedBin, m_NInpaint, m_EqualVarPerScale, m_ForceBMode, m_nbScales, m_add_borders,
             m_RSsigmaGauss, m_sigmaGauss, m_nbSamples, m_RSthresholdFDR, m_thresholdFDR);
+ param.setConvergenceTolerance(m_convergenceTolerance);
+ return param;
+ }
+
+ std::vector<boost::filesystem::path> Parameters::writePatchParameterFiles(
+     const boost::filesystem::path& parameter_file) {
+  namespace params = dpd::le3::wl::twodmass::inp::paramsconvergencepatch;
+  auto product = params::DpdTwoDMassParamsConvergencePatch(parameter_file.string(), xml_schema::flags::dont_validate);
+
+  // Every patch of every PatchParams element is written alone in a copy of the product
+  const auto patchParams = product->Data().PatchParams();
+  std::size_t nbPatches = 0;
+  for (const auto& patches : patchParams) {
+    nbPatches += patches.PatchList().size();
+  }
+  std::vector<boost::filesystem::path> files;
+  if (nbPatches <= 1) {
+    return files;
+  }
+  for (const auto& patches : patchParams) {
+    for (const auto& patch : patches.PatchList()) {
+      auto single = patches;
+      single.NPatches(1);
+      single.PatchList().clear();
+      single.PatchList().push_back(patch);
+      product->Data().PatchParams().clear();
+      product->Data().PatchParams().push_back(single);
+
+      std::ostringstream suffix;
+      suffix << "_" << std::setw(4) << std::setfill('0') << files.size();
+      boost::filesystem::path file = parameter_file.parent_path() / (parameter_file.stem().string() + suffix.str()
+                                                                     + parameter_file.extension().string());
+      std::ofstream out(file.string(), std::ios::trunc);
+      params::DpdTwoDMassParamsConvergencePatch(out, *product);
+      out.close();
+      if (!out) {
+        throw Elements::Exception() << "Cannot write parameter file " << file;
+      }
+      files.push_back(file);
+    }
+  }
+  logger.info() << "Split " << parameter_file << " in " << files.size() << " parameter files of one patch";
+  return files;
  }
 
- std::vector<double> Parameters::getZMin(){ return m_zMin; }
+ const std::vector<double>& Parameters::getZMin(){ return m_zMin; }
  double Parameters::getZMax(){ return m_zMax; }
  float Parameters::getPixelsize(){ return m_PixelSize; }
  float Parameters::getSigmaGauss(){ return m_sigmaGauss; }
@@ -105,8 +157,8 @@ namespace DmModule {
  int Parameters::getNItReducedShear(){ return m_NItReducedShear; }
  int Parameters::getnbScales(){ return m_nbScales; }
  float Parameters::getPatchWidth(){ return m_PatchWidth; }
- std::vector<double> Parameters::getMapCenterX(){ return mapCenterX; }
- std::vector<double> Parameters::getMapCenterY(){ return mapCenterY; }
+ const std::vector<double>& Parameters::getMapCenterX(){ return mapCenterX; }
+ const std::vector<double>& Parameters::getMapCenterY(){ return mapCenterY; }
  int Parameters::getNSamples() { return m_nbSamples;}
 
  long Parameters::get_addBorders(){
@@ -121,5 +173,11 @@ namespace DmModule {
  long Parameters::get_BalancedBins(){
   return m_balancedBin;
  }
+ double Parameters::getConvergenceTolerance(){
+  return m_convergenceTolerance;
+ }
+ void Parameters::setConvergenceTolerance(double tolerance){
+  m_convergenceTolerance = tolerance;
+ }
 
 }  // namespace DmModule
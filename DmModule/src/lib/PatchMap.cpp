@@ -0,0 +1,87 @@
+/**
+ * @file src/lib/PatchMap.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/PatchMap.h"
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("PatchMap");
+
+namespace DmModule {
+
+ PatchMap::PatchMap(std::size_t xdim, std::size_t ydim, std::size_t nbLayers, double pixelSize,
+                    double centerX, double centerY)
+      : m_xdim(xdim), m_ydim(ydim), m_nbLayers(nbLayers), m_pixelSize(pixelSize),
+        m_centerX(centerX), m_centerY(centerY), m_data(xdim * ydim * nbLayers, 0.) {
+ }
+
+ void PatchMap::writeFits(const fs::path& filename, const std::vector<PatchMap>& maps) {
+  logger.info() << "Writing " << maps.size() << " maps in FITS file " << filename << " ...";
+
+  fitsfile* fptr = nullptr;
+  int status = 0;
+
+  // The leading '!' asks CFITSIO to overwrite an existing file. CFITSIO routines
+  // do nothing when status is already set, so it is enough to check it at the end.
+  fits_create_file(&fptr, ("!" + filename.string()).c_str(), &status);
+  fits_create_img(fptr, DOUBLE_IMG, 0, nullptr, &status);
+
+  for (const auto& map : maps) {
+    map.writeFitsHdu(fptr, &status);
+  }
+
+  int close_status = 0;
+  if (fptr != nullptr) {
+    fits_close_file(fptr, &close_status);
+  }
+  if (status == 0) {
+    status = close_status;
+  }
+  if (status != 0) {
+    char message[FLEN_STATUS];
+    fits_get_errstatus(status, message);
+    throw Elements::Exception() << "Cannot write FITS file " << filename << ": " << message;
+  }
+ }
+
+ void PatchMap::writeFitsHdu(fitsfile* fptr, int* status) const {
+  long naxes[3] = {static_cast<long>(m_xdim), static_cast<long>(m_ydim), static_cast<long>(m_nbLayers)};
+  fits_create_img(fptr, DOUBLE_IMG, 3, naxes, status);
+
+  double crpix1 = m_xdim / 2. + 0.5, crpix2 = m_ydim / 2. + 0.5;
+  double centerX = m_centerX, centerY = m_centerY, pixelSize = m_pixelSize;
+  fits_write_key(fptr, TSTRING, "CTYPE1", const_cast<char*>("RA---TAN"), "Gnomonic projection", status);
+  fits_write_key(fptr, TSTRING, "CTYPE2", const_cast<char*>("DEC--TAN"), "Gnomonic projection", status);
+  fits_write_key(fptr, TDOUBLE, "CRPIX1", &crpix1, "Reference pixel along X", status);
+  fits_write_key(fptr, TDOUBLE, "CRPIX2", &crpix2, "Reference pixel along Y", status);
+  fits_write_key(fptr, TDOUBLE, "CRVAL1", &centerX, "[deg] Map center at X-axis (Ra)", status);
+  fits_write_key(fptr, TDOUBLE, "CRVAL2", &centerY, "[deg] Map center at Y-axis (Dec)", status);
+  fits_write_key(fptr, TDOUBLE, "CDELT1", &pixelSize, "[deg] Pixel size", status);
+  fits_write_key(fptr, TDOUBLE, "CDELT2", &pixelSize, "[deg] Pixel size", status);
+
+  fits_write_img(fptr, TDOUBLE, 1, m_data.size(), const_cast<double*>(m_data.data()), status);
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,301 @@
+/**
+ * @file src/lib/ProcessExecutor.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/ProcessExecutor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+extern char** environ;
+
+static Elements::Logging logger = Elements::Logging::getLogger("ProcessExecutor");
+
+namespace {
+
+// Poll interval while a child closed its pipes but was not reaped yet
+const int reapIntervalMs = 5;
+
+void closeFd(int& fd) {
+  if (fd >= 0) {
+    ::close(fd);
+    fd = -1;
+  }
+}
+
+// Reads what is available without blocking, closes the pipe at its end
+void drain(int& fd, std::string& output) {
+  char buffer[65536];
+  while (fd >= 0) {
+    ssize_t size = ::read(fd, buffer, sizeof(buffer));
+    if (size > 0) {
+      output.append(buffer, static_cast<std::size_t>(size));
+    } else if (size < 0 && errno == EINTR) {
+      continue;
+    } else {
+      if (size == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+        closeFd(fd);
+      }
+      return;
+    }
+  }
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ struct ProcessExecutor::Child {
+  pid_t pid;
+  int out, err;
+  bool killed;
+  std::chrono::steady_clock::time_point started, deadline;
+  Result result;
+  std::shared_ptr<std::promise<Result>> done;
+ };
+
+ std::string ProcessExecutor::Result::describe() const {
+  if (timedOut) {
+    return "timeout after " + std::to_string(duration.count()) + " ms";
+  }
+  if (signal != 0) {
+    return "signal " + std::to_string(signal);
+  }
+  return "exit status " + std::to_string(status);
+ }
+
+ ProcessExecutor::ProcessExecutor(unsigned maxChildren)
+      : m_maxChildren(maxChildren > 0 ? maxChildren : std::max(1u, std::thread::hardware_concurrency())),
+        m_nbRunning(0), m_stopping(false) {
+  if (::pipe2(m_wakeup, O_CLOEXEC | O_NONBLOCK) != 0) {
+    throw Elements::Exception() << "Cannot create the wake-up pipe: " << std::strerror(errno);
+  }
+  m_poller = std::thread(&ProcessExecutor::pollLoop, this);
+ }
+
+ ProcessExecutor::~ProcessExecutor() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  char byte = 0;
+  while (::write(m_wakeup[1], &byte, 1) < 0 && errno == EINTR) {
+  }
+  m_poller.join();
+  ::close(m_wakeup[0]);
+  ::close(m_wakeup[1]);
+ }
+
+ std::future<ProcessExecutor::Result> ProcessExecutor::submit(std::vector<std::string> argv,
+                                                              std::chrono::milliseconds timeout) {
+  if (argv.empty()) {
+    throw Elements::Exception() << "No program to run";
+  }
+  auto done = std::make_shared<std::promise<Result>>();
+  std::future<Result> result = done->get_future();
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.push_back(Job{std::move(argv), timeout, done});
+  }
+  // A full pipe already holds a wake-up
+  char byte = 0;
+  while (::write(m_wakeup[1], &byte, 1) < 0 && errno == EINTR) {
+  }
+  return result;
+ }
+
+ std::size_t ProcessExecutor::getNbRunning() const {
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_nbRunning;
+ }
+
+ void ProcessExecutor::start(Job& job, std::vector<std::unique_ptr<Child>>& children) {
+  int out[2] = {-1, -1}, err[2] = {-1, -1};
+  if (::pipe2(out, O_CLOEXEC) != 0 || ::pipe2(err, O_CLOEXEC) != 0) {
+    int error = errno;
+    for (int fd : {out[0], out[1], err[0], err[1]}) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+    job.done->set_exception(std::make_exception_ptr(Elements::Exception()
+        << "Cannot create the pipes of " << job.argv.front() << ": " << std::strerror(error)));
+    return;
+  }
+
+  // The write ends are duplicated on the standard streams of the child, which
+  // clears their close-on-exec flag; SIGPIPE gets its default action back. The
+  // child leads a new process group, so that its descendants can be killed with it
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, out[1], STDOUT_FILENO);
+  posix_spawn_file_actions_adddup2(&actions, err[1], STDERR_FILENO);
+  posix_spawnattr_t attributes;
+  posix_spawnattr_init(&attributes);
+  sigset_t defaults;
+  sigemptyset(&defaults);
+  sigaddset(&defaults, SIGPIPE);
+  posix_spawnattr_setsigdefault(&attributes, &defaults);
+  posix_spawnattr_setpgroup(&attributes, 0);
+  posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+  std::vector<char*> argv;
+  for (auto& arg : job.argv) {
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+
+  pid_t pid = -1;
+  int error = ::posix_spawnp(&pid, argv[0], &actions, &attributes, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  posix_spawnattr_destroy(&attributes);
+  ::close(out[1]);
+  ::close(err[1]);
+  if (error != 0) {
+    ::close(out[0]);
+    ::close(err[0]);
+    job.done->set_exception(std::make_exception_ptr(Elements::Exception()
+        << "Cannot run " << job.argv.front() << ": " << std::strerror(error)));
+    return;
+  }
+  ::fcntl(out[0], F_SETFL, ::fcntl(out[0], F_GETFL) | O_NONBLOCK);
+  ::fcntl(err[0], F_SETFL, ::fcntl(err[0], F_GETFL) | O_NONBLOCK);
+
+  std::unique_ptr<Child> child(new Child());
+  child->pid = pid;
+  child->out = out[0];
+  child->err = err[0];
+  child->killed = false;
+  child->started = std::chrono::steady_clock::now();
+  child->deadline = job.timeout.count() > 0 ? child->started + job.timeout
+                                            : std::chrono::steady_clock::time_point::max();
+  child->result = Result{0, 0, false, "", "", std::chrono::milliseconds(0)};
+  child->done = job.done;
+  logger.debug() << "Started " << job.argv.front() << " as process " << pid;
+  children.push_back(std::move(child));
+ }
+
+ void ProcessExecutor::pollLoop() {
+  std::vector<std::unique_ptr<Child>> children;
+  std::vector<struct pollfd> fds;
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      while (!m_pending.empty() && children.size() < m_maxChildren) {
+        Job job = std::move(m_pending.front());
+        m_pending.pop_front();
+        start(job, children);
+      }
+      m_nbRunning = children.size();
+      if (m_stopping && m_pending.empty() && children.empty()) {
+        return;
+      }
+    }
+
+    // Wait for output, for the next deadline or, once the pipes of a child are
+    // closed, for its end
+    auto now = std::chrono::steady_clock::now();
+    int timeout = -1;
+    fds.assign(1, pollfd{m_wakeup[0], POLLIN, 0});
+    for (const auto& child : children) {
+      for (int fd : {child->out, child->err}) {
+        if (fd >= 0) {
+          fds.push_back(pollfd{fd, POLLIN, 0});
+        }
+      }
+      int wait = -1;
+      if (child->out < 0 && child->err < 0) {
+        wait = reapIntervalMs;
+      } else if (child->deadline != std::chrono::steady_clock::time_point::max()) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(child->deadline - now).count() + 1;
+        wait = static_cast<int>(std::max<decltype(left)>(left, 0));
+      }
+      if (wait >= 0) {
+        timeout = timeout < 0 ? wait : std::min(timeout, wait);
+      }
+    }
+    if (::poll(fds.data(), fds.size(), timeout) < 0 && errno != EINTR) {
+      logger.error() << "Cannot poll the children: " << std::strerror(errno);
+    }
+
+    char buffer[64];
+    while (::read(m_wakeup[0], buffer, sizeof(buffer)) > 0) {
+    }
+
+    now = std::chrono::steady_clock::now();
+    for (auto it = children.begin(); it != children.end();) {
+      Child& child = **it;
+      drain(child.out, child.result.out);
+      drain(child.err, child.result.err);
+
+      // The whole process group of the child is killed. Descendants which left
+      // it may still hold the pipes open, they are closed
+      if (!child.killed && now >= child.deadline) {
+        logger.warn() << "Killing process group " << child.pid << " after its timeout";
+        ::kill(-child.pid, SIGKILL);
+        child.killed = true;
+        child.result.timedOut = true;
+        closeFd(child.out);
+        closeFd(child.err);
+      }
+
+      int status = 0;
+      pid_t reaped = 0;
+      if (child.out < 0 && child.err < 0) {
+        while ((reaped = ::waitpid(child.pid, &status, WNOHANG)) < 0 && errno == EINTR) {
+        }
+      }
+      if (reaped == 0) {
+        ++it;
+        continue;
+      }
+
+      Result& result = child.result;
+      result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(now - child.started);
+      if (reaped < 0) {
+        result.status = -1;
+      } else if (WIFEXITED(status)) {
+        result.status = WEXITSTATUS(status);
+      } else if (WIFSIGNALED(status)) {
+        result.status = -1;
+        result.signal = WTERMSIG(status);
+      }
+      logger.debug() << "Process " << child.pid << " ended with " << result.describe();
+      child.done->set_value(std::move(result));
+      it = children.erase(it);
+    }
+  }
+ }
+
+}  // namespace DmModule
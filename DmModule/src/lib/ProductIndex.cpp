@@ -0,0 +1,384 @@
+/**
+ * @file src/lib/ProductIndex.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/ProductIndex.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+#include "DmModule/WorkerPool.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("ProductIndex");
+
+namespace {
+
+// Identifies the format of the index file, to be changed with the format
+const char magic[8] = {'D', 'M', 'I', 'D', 'X', '0', '0', '1'};
+
+// Number of products handled by one task of the scan
+const std::size_t chunkSize = 256;
+
+// Longest file name or product type, longer strings come from a corrupted index
+const std::uint32_t maxStringSize = 1 << 16;
+
+std::int64_t modificationTime(const struct stat& status) {
+  return static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+}
+
+bool statFile(const fs::path& filename, std::uint64_t& size, std::int64_t& mtime) {
+  struct stat status;
+  if (::stat(filename.c_str(), &status) != 0 || !S_ISREG(status.st_mode)) {
+    return false;
+  }
+  size = static_cast<std::uint64_t>(status.st_size);
+  mtime = modificationTime(status);
+  return true;
+}
+
+std::string xmlUnescape(const std::string& text) {
+  static const std::pair<const char*, char> entities[] = {
+      {"&amp;", '&'}, {"&lt;", '<'}, {"&gt;", '>'}, {"&quot;", '"'}, {"&apos;", '\''}};
+  std::string plain;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    bool replaced = false;
+    if (text[i] == '&') {
+      for (const auto& entity : entities) {
+        std::size_t length = std::strlen(entity.first);
+        if (text.compare(i, length, entity.first) == 0) {
+          plain += entity.second;
+          i += length - 1;
+          replaced = true;
+          break;
+        }
+      }
+    }
+    if (!replaced) {
+      plain += text[i];
+    }
+  }
+  return plain;
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(std::ostream& out, const std::string& text) {
+  writeValue(out, static_cast<std::uint32_t>(text.size()));
+  out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+template <typename T>
+T readValue(std::istream& in) {
+  T value = T();
+  in.read(reinterpret_cast<char*>(&value), sizeof(value));
+  return value;
+}
+
+std::string readString(std::istream& in) {
+  std::uint32_t size = readValue<std::uint32_t>(in);
+  std::string text;
+  if (size > maxStringSize) {
+    in.setstate(std::ios::failbit);
+  }
+  if (in) {
+    text.resize(size);
+    in.read(&text[0], static_cast<std::streamsize>(size));
+  }
+  return text;
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ void ProductIndex::parseProduct(const std::string& content, Product& product) {
+  product.type.clear();
+  product.dataFiles.clear();
+
+  // Scan of the tags, skipping the XML declaration, the comments, the CDATA
+  // sections and the DOCTYPE: the first element is the root, giving the type,
+  // and the text of the FileName elements gives the data files. The elements
+  // are matched on their local name, with any namespace prefix and attributes.
+  std::size_t position = 0;
+  while ((position = content.find('<', position)) != std::string::npos) {
+    if (content.compare(position, 4, "<!--") == 0) {
+      position = content.find("-->", position);
+      continue;
+    }
+    if (content.compare(position, 9, "<![CDATA[") == 0) {
+      position = content.find("]]>", position);
+      continue;
+    }
+    if (content.compare(position, 2, "<?") == 0 || content.compare(position, 2, "<!") == 0
+        || content.compare(position, 2, "</") == 0) {
+      position = content.find('>', position);
+      continue;
+    }
+    std::size_t nameEnd = content.find_first_of(" \t\r\n/>", position + 1);
+    std::size_t tagEnd = content.find('>', position);
+    if (nameEnd == std::string::npos || tagEnd == std::string::npos) {
+      break;
+    }
+    std::string name = content.substr(position + 1, nameEnd - position - 1);
+    std::string localName = name.substr(name.find(':') + 1);
+    if (product.type.empty()) {
+      product.type = localName;
+    }
+    position = tagEnd + 1;
+    if (localName != "FileName" || content[tagEnd - 1] == '/') {
+      continue;
+    }
+    // text only, up to the end tag
+    std::size_t end = content.find('<', position);
+    if (end == std::string::npos) {
+      break;
+    }
+    DataFile dataFile {xmlUnescape(content.substr(position, end - position)), false, 0, 0};
+    product.dataFiles.push_back(dataFile);
+    position = end;
+  }
+ }
+
+ ProductIndex::ProductIndex(const fs::path& workdir, const fs::path& index_file)
+      : m_workdir(workdir), m_indexFile(index_file.empty() ? workdir / ".DmProductIndex" : index_file),
+        m_complete(false) {
+  load();
+ }
+
+ std::size_t ProductIndex::update(unsigned nbThreads) {
+  std::vector<std::string> files;
+  for (fs::directory_iterator it(m_workdir.empty() ? fs::path(".") : m_workdir), end; it != end; ++it) {
+    if (it->path().extension() == ".xml" && fs::is_regular_file(it->status())) {
+      files.push_back(it->path().filename().string());
+    }
+  }
+
+  // The unchanged products keep their entry, the others are parsed again;
+  // the data files are checked for all of them
+  std::vector<Product> products(files.size());
+  std::vector<char> found(files.size(), 0), parsed(files.size(), 0);
+  {
+    WorkerPool pool(nbThreads);
+    std::vector<std::future<void>> chunks;
+    for (std::size_t first = 0; first < files.size(); first += chunkSize) {
+      std::size_t last = std::min(files.size(), first + chunkSize);
+      chunks.push_back(pool.submit([this, first, last, &files, &products, &found, &parsed]() {
+        for (std::size_t i = first; i < last; ++i) {
+          bool parsedProduct = false;
+          found[i] = scanProduct(files[i], products[i], parsedProduct);
+          parsed[i] = parsedProduct;
+        }
+      }));
+    }
+    for (auto& chunk : chunks) {
+      chunk.get();
+    }
+  }
+
+  std::map<std::string, Product> updated;
+  std::size_t nbParsed = 0;
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    if (found[i]) {
+      nbParsed += parsed[i];
+      updated[files[i]] = std::move(products[i]);
+    }
+  }
+  logger.info() << "Indexed " << updated.size() << " products of " << m_workdir << ", " << nbParsed
+                << " of them parsed";
+  m_products.swap(updated);
+  m_complete = true;
+  return nbParsed;
+ }
+
+ bool ProductIndex::refresh(const fs::path& file) {
+  Product product;
+  bool parsed = false;
+  if (scanProduct(file.string(), product, parsed)) {
+    m_products[file.string()] = std::move(product);
+  } else {
+    m_products.erase(file.string());
+  }
+  return parsed;
+ }
+
+ bool ProductIndex::isStale() const {
+  struct stat indexStatus, workdirStatus;
+  if (!m_complete || ::stat(m_indexFile.c_str(), &indexStatus) != 0
+      || ::stat((m_workdir.empty() ? fs::path(".") : m_workdir).c_str(), &workdirStatus) != 0) {
+    return true;
+  }
+  return modificationTime(workdirStatus) > modificationTime(indexStatus);
+ }
+
+ bool ProductIndex::scanProduct(const std::string& file, Product& product, bool& parsed) const {
+  product.file = file;
+  if (!statFile(m_workdir / file, product.size, product.mtime)) {
+    return false;
+  }
+  auto known = m_products.find(file);
+  if (known != m_products.end() && known->second.size == product.size && known->second.mtime == product.mtime) {
+    product = known->second;
+  } else {
+    std::ifstream in((m_workdir / file).string(), std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    parseProduct(content, product);
+    parsed = true;
+  }
+  for (auto& dataFile : product.dataFiles) {
+    dataFile.exists = statFile(m_workdir / "data" / dataFile.name, dataFile.size, dataFile.mtime);
+    if (!dataFile.exists) {
+      dataFile.size = 0;
+      dataFile.mtime = 0;
+    }
+  }
+  return true;
+ }
+
+ void ProductIndex::save() const {
+  fs::path part = m_indexFile.parent_path() / fs::unique_path("." + m_indexFile.filename().string() + ".%%%%%%.part");
+  {
+    std::ofstream out(part.string(), std::ios::binary | std::ios::trunc);
+    out.write(magic, sizeof(magic));
+    writeValue(out, static_cast<std::uint64_t>(m_products.size()));
+    for (const auto& entry : m_products) {
+      const Product& product = entry.second;
+      writeString(out, product.file);
+      writeString(out, product.type);
+      writeValue(out, product.size);
+      writeValue(out, product.mtime);
+      writeValue(out, static_cast<std::uint32_t>(product.dataFiles.size()));
+      for (const auto& dataFile : product.dataFiles) {
+        writeString(out, dataFile.name);
+        writeValue(out, static_cast<std::uint8_t>(dataFile.exists));
+        writeValue(out, dataFile.size);
+        writeValue(out, dataFile.mtime);
+      }
+    }
+    out.close();
+    if (!out) {
+      boost::system::error_code error;
+      fs::remove(part, error);
+      throw Elements::Exception() << "Cannot write the product index " << part;
+    }
+  }
+  fs::rename(part, m_indexFile);
+
+  // The index is up to date with the working directory as it is now, including
+  // the rename of the index itself when it is in the working directory
+  struct stat workdirStatus;
+  if (::stat((m_workdir.empty() ? fs::path(".") : m_workdir).c_str(), &workdirStatus) == 0) {
+    struct timespec times[2] = {{0, UTIME_OMIT}, workdirStatus.st_mtim};
+    ::utimensat(AT_FDCWD, m_indexFile.c_str(), times, 0);
+  }
+ }
+
+ void ProductIndex::load() {
+  m_products.clear();
+  std::ifstream in(m_indexFile.string(), std::ios::binary);
+  if (!in) {
+    return;
+  }
+  char header[sizeof(magic)] = {};
+  in.read(header, sizeof(header));
+  if (!in || std::memcmp(header, magic, sizeof(magic)) != 0) {
+    logger.warn() << "Ignoring the product index " << m_indexFile << " in an unknown format";
+    return;
+  }
+  std::uint64_t nbProducts = readValue<std::uint64_t>(in);
+  for (std::uint64_t p = 0; p < nbProducts && in; ++p) {
+    Product product;
+    product.file = readString(in);
+    product.type = readString(in);
+    product.size = readValue<std::uint64_t>(in);
+    product.mtime = readValue<std::int64_t>(in);
+    std::uint32_t nbDataFiles = readValue<std::uint32_t>(in);
+    for (std::uint32_t d = 0; d < nbDataFiles && in; ++d) {
+      DataFile dataFile;
+      dataFile.name = readString(in);
+      dataFile.exists = readValue<std::uint8_t>(in) != 0;
+      dataFile.size = readValue<std::uint64_t>(in);
+      dataFile.mtime = readValue<std::int64_t>(in);
+      product.dataFiles.push_back(dataFile);
+    }
+    m_products[product.file] = std::move(product);
+  }
+  if (!in) {
+    logger.warn() << "Ignoring the truncated product index " << m_indexFile;
+    m_products.clear();
+    return;
+  }
+  m_complete = true;
+  logger.debug() << "Loaded " << m_products.size() << " products from " << m_indexFile;
+ }
+
+ const ProductIndex::Product* ProductIndex::find(const fs::path& file) const {
+  auto it = m_products.find(file.string());
+  return it == m_products.end() ? nullptr : &it->second;
+ }
+
+ const ProductIndex::Product& ProductIndex::resolve(const fs::path& file, const std::string& type) const {
+  const Product* product = find(file);
+  if (product == nullptr) {
+    throw Elements::Exception() << "XML data product " << m_workdir / file << " not found";
+  }
+  if (!type.empty() && product->type != type) {
+    throw Elements::Exception() << "XML data product " << m_workdir / file << " is a " << product->type
+                                << ", expected a " << type;
+  }
+  return *product;
+ }
+
+ std::vector<const ProductIndex::Product*> ProductIndex::findByType(const std::string& type) const {
+  std::vector<const Product*> products;
+  for (const auto& entry : m_products) {
+    if (entry.second.type == type) {
+      products.push_back(&entry.second);
+    }
+  }
+  return products;
+ }
+
+ std::vector<const ProductIndex::Product*> ProductIndex::findByDataFile(const std::string& name) const {
+  std::vector<const Product*> products;
+  for (const auto& entry : m_products) {
+    const auto& dataFiles = entry.second.dataFiles;
+    if (std::any_of(dataFiles.begin(), dataFiles.end(), [&name](const DataFile& file) { return file.name == name; })) {
+      products.push_back(&entry.second);
+    }
+  }
+  return products;
+ }
+
+}  // namespace DmModule
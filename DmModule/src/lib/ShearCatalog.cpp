@@ -0,0 +1,137 @@
+/**
+ * @file src/lib/ShearCatalog.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/ShearCatalog.h"
+
+#include <string>
+#include <fitsio.h>
+
+#include "ElementsKernel/Exception.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("ShearCatalog");
+
+namespace {
+
+// Accepted column names, the LensMC names first
+const std::vector<std::string> ra_names {"SHE_LENSMC_RA", "RA"};
+const std::vector<std::string> dec_names {"SHE_LENSMC_DEC", "DEC"};
+const std::vector<std::string> gamma1_names {"SHE_LENSMC_G1", "G1", "GAMMA1"};
+const std::vector<std::string> gamma2_names {"SHE_LENSMC_G2", "G2", "GAMMA2"};
+const std::vector<std::string> weight_names {"SHE_LENSMC_WEIGHT", "WEIGHT"};
+const std::vector<std::string> z_names {"PHZ_MEDIAN", "Z"};
+
+std::string fitsMessage(int status) {
+  char message[FLEN_STATUS];
+  fits_get_errstatus(status, message);
+  return message;
+}
+
+/*
+ * Return the number of the first column matching one of the names, 0 if none matches
+ */
+int findColumn(fitsfile* fptr, const std::vector<std::string>& names) {
+  for (const auto& name : names) {
+    int status = 0, colnum = 0;
+    fits_get_colnum(fptr, CASEINSEN, const_cast<char*>(name.c_str()), &colnum, &status);
+    if (status == 0) {
+      return colnum;
+    }
+  }
+  return 0;
+}
+
+std::vector<double> readColumn(fitsfile* fptr, int colnum, long nrows, const fs::path& catalog_file) {
+  std::vector<double> values(nrows);
+  int status = 0, anynul = 0;
+  double nulval = 0.;
+  fits_read_col(fptr, TDOUBLE, colnum, 1, 1, nrows, &nulval, values.data(), &anynul, &status);
+  if (status != 0) {
+    throw Elements::Exception() << "Cannot read column " << colnum << " of " << catalog_file
+                                << ": " << fitsMessage(status);
+  }
+  return values;
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ ShearCatalog::ShearCatalog(std::vector<double> ra, std::vector<double> dec, std::vector<double> gamma1,
+                            std::vector<double> gamma2, std::vector<double> weight, std::vector<double> z)
+      : m_ra(std::move(ra)), m_dec(std::move(dec)), m_gamma1(std::move(gamma1)),
+        m_gamma2(std::move(gamma2)), m_weight(std::move(weight)), m_z(std::move(z)) {
+  std::size_t nb = m_ra.size();
+  if (m_dec.size() != nb || m_gamma1.size() != nb || m_gamma2.size() != nb
+      || m_weight.size() != nb || m_z.size() != nb) {
+    throw Elements::Exception() << "Shear catalog columns do not have the same length";
+  }
+ }
+
+ ShearCatalog ShearCatalog::readFits(const fs::path& catalog_file) {
+  logger.info() << "Reading shear catalog " << catalog_file << " ...";
+
+  fitsfile* fptr = nullptr;
+  int status = 0;
+  fits_open_table(&fptr, catalog_file.string().c_str(), READONLY, &status);
+  if (status != 0) {
+    throw Elements::Exception() << "Cannot open FITS catalog " << catalog_file << ": " << fitsMessage(status);
+  }
+
+  long nrows = 0;
+  fits_get_num_rows(fptr, &nrows, &status);
+
+  int ra_col = findColumn(fptr, ra_names), dec_col = findColumn(fptr, dec_names);
+  int gamma1_col = findColumn(fptr, gamma1_names), gamma2_col = findColumn(fptr, gamma2_names);
+  int weight_col = findColumn(fptr, weight_names), z_col = findColumn(fptr, z_names);
+
+  std::vector<double> ra, dec, gamma1, gamma2, weight, z;
+  try {
+    if (status != 0 || ra_col == 0 || dec_col == 0 || gamma1_col == 0 || gamma2_col == 0 || z_col == 0) {
+      throw Elements::Exception() << "FITS catalog " << catalog_file
+                                  << " does not have the position, shear and redshift columns";
+    }
+    ra = readColumn(fptr, ra_col, nrows, catalog_file);
+    dec = readColumn(fptr, dec_col, nrows, catalog_file);
+    gamma1 = readColumn(fptr, gamma1_col, nrows, catalog_file);
+    gamma2 = readColumn(fptr, gamma2_col, nrows, catalog_file);
+    z = readColumn(fptr, z_col, nrows, catalog_file);
+    if (weight_col != 0) {
+      weight = readColumn(fptr, weight_col, nrows, catalog_file);
+    } else {
+      logger.debug() << "No weight column, using unit weights";
+      weight.assign(nrows, 1.);
+    }
+  } catch (...) {
+    status = 0;
+    fits_close_file(fptr, &status);
+    throw;
+  }
+  fits_close_file(fptr, &status);
+
+  logger.info() << "Read " << nrows << " galaxies from " << catalog_file;
+  return ShearCatalog(std::move(ra), std::move(dec), std::move(gamma1), std::move(gamma2),
+                      std::move(weight), std::move(z));
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,109 @@
+/**
+ * @file src/lib/Starlet.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/Starlet.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const double b3spline[5] = {1. / 16., 4. / 16., 6. / 16., 4. / 16., 1. / 16.};
+
+// Mirror the index on the borders
+long mirror(long i, long n) {
+  if (n == 1) {
+    return 0;
+  }
+  while (i < 0 || i >= n) {
+    i = i < 0 ? -i : 2 * (n - 1) - i;
+  }
+  return i;
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ Starlet::Starlet(std::size_t xdim, std::size_t ydim, int nbScales)
+      : m_xdim(xdim), m_ydim(ydim), m_nbScales(nbScales), m_work(xdim * ydim) {
+  if (m_nbScales <= 0) {
+    double size = static_cast<double>(std::min(xdim, ydim));
+    m_nbScales = std::max(2, static_cast<int>(std::floor(std::log2(size))) - 2);
+  }
+ }
+
+ void Starlet::transform(const double* image, std::vector<double>& coefficients) const {
+  std::size_t nbPixels = m_xdim * m_ydim;
+  coefficients.resize(m_nbScales * nbPixels);
+
+  // the smooth approximation of each scale is built in place of the next scale
+  std::copy(image, image + nbPixels, coefficients.begin());
+  std::size_t step = 1;
+  for (int s = 0; s < m_nbScales - 1; ++s) {
+    double* current = coefficients.data() + s * nbPixels;
+    double* next = current + nbPixels;
+    smooth(current, next, step);
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      current[k] -= next[k];
+    }
+    step *= 2;
+  }
+ }
+
+ void Starlet::reconstruct(const std::vector<double>& coefficients, double* image) const {
+  std::size_t nbPixels = m_xdim * m_ydim;
+  std::fill(image, image + nbPixels, 0.);
+  for (int s = 0; s < m_nbScales; ++s) {
+    const double* scale = coefficients.data() + s * nbPixels;
+    for (std::size_t k = 0; k < nbPixels; ++k) {
+      image[k] += scale[k];
+    }
+  }
+ }
+
+ void Starlet::smooth(const double* in, double* out, std::size_t step) const {
+  long xdim = static_cast<long>(m_xdim), ydim = static_cast<long>(m_ydim), hole = static_cast<long>(step);
+
+  // separable convolution, rows into the work buffer then columns into out
+  for (long y = 0; y < ydim; ++y) {
+    for (long x = 0; x < xdim; ++x) {
+      double sum = 0.;
+      for (long t = -2; t <= 2; ++t) {
+        sum += b3spline[t + 2] * in[y * xdim + mirror(x + t * hole, xdim)];
+      }
+      m_work[y * xdim + x] = sum;
+    }
+  }
+  for (long y = 0; y < ydim; ++y) {
+    for (long x = 0; x < xdim; ++x) {
+      double sum = 0.;
+      for (long t = -2; t <= 2; ++t) {
+        sum += b3spline[t + 2] * m_work[mirror(y + t * hole, ydim) * xdim + x];
+      }
+      out[y * xdim + x] = sum;
+    }
+  }
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,156 @@
+/**
+ * @file src/lib/Topology.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "DmModule/Topology.h"
+
+#include <algorithm>
+#include <thread>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+namespace fs = boost::filesystem;
+static Elements::Logging logger = Elements::Logging::getLogger("Topology");
+
+namespace {
+
+// CPUs the process may run on
+std::vector<int> allowedCpus() {
+  std::vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+  if (cpus.empty()) {
+    unsigned nbCpus = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned cpu = 0; cpu < nbCpus; ++cpu) {
+      cpus.push_back(static_cast<int>(cpu));
+    }
+  }
+  return cpus;
+}
+
+}  // namespace
+
+namespace DmModule {
+
+ Topology Topology::detect(const fs::path& sysfs_dir) {
+  std::vector<int> allowed = allowedCpus();
+  // the node ids may have holes (offline or memory-only nodes), so list the
+  // nodeN directories instead of counting from 0
+  std::vector<int> nodeIds;
+  boost::system::error_code error;
+  for (fs::directory_iterator it(sysfs_dir, error), end; !error && it != end; it.increment(error)) {
+    std::string name = it->path().filename().string();
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0
+        && name.find_first_not_of("0123456789", 4) == std::string::npos) {
+      nodeIds.push_back(std::stoi(name.substr(4)));
+    }
+  }
+  std::sort(nodeIds.begin(), nodeIds.end());
+  std::vector<std::vector<int>> nodeCpus;
+  std::vector<int> usedIds;
+  for (int node : nodeIds) {
+    fs::ifstream in(sysfs_dir / ("node" + std::to_string(node)) / "cpulist");
+    std::string list;
+    std::getline(in, list);
+    std::vector<int> cpus;
+    for (int cpu : parseCpuList(list)) {
+      if (std::binary_search(allowed.begin(), allowed.end(), cpu)) {
+        cpus.push_back(cpu);
+      }
+    }
+    if (!cpus.empty()) {
+      nodeCpus.push_back(cpus);
+      usedIds.push_back(node);
+    }
+  }
+  Topology topology(nodeCpus);
+  if (!usedIds.empty()) {
+    topology.m_nodeIds = usedIds;
+  }
+  logger.debug() << "Found " << topology.getNbNodes() << " NUMA nodes with " << allowed.size() << " CPUs";
+  return topology;
+ }
+
+ std::vector<int> Topology::parseCpuList(const std::string& list) {
+  std::vector<int> cpus;
+  std::vector<std::string> ranges;
+  std::string trimmed = boost::trim_copy(list);
+  if (trimmed.empty()) {
+    return cpus;
+  }
+  boost::split(ranges, trimmed, boost::is_any_of(","));
+  for (const auto& range : ranges) {
+    try {
+      std::size_t dash = range.find('-');
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception&) {
+      throw Elements::Exception() << "Invalid CPU list \"" << list << "\"";
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+  return cpus;
+ }
+
+ bool Topology::pinCurrentThread(const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu >= 0 && cpu < CPU_SETSIZE) {
+      CPU_SET(cpu, &set);
+    }
+  }
+  return CPU_COUNT(&set) > 0 && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+ }
+
+ Topology::Topology(std::vector<std::vector<int>> node_cpus) {
+  for (std::size_t node = 0; node < node_cpus.size(); ++node) {
+    if (!node_cpus[node].empty()) {
+      m_nodeCpus.push_back(std::move(node_cpus[node]));
+      m_nodeIds.push_back(static_cast<int>(node));
+    }
+  }
+  if (m_nodeCpus.empty()) {
+    m_nodeCpus.push_back(allowedCpus());
+    m_nodeIds.push_back(0);
+  }
+ }
+
+}  // namespace DmModule
@@ -0,0 +1,153 @@
+/**
+ * @file src/lib/WorkerPool.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <algorithm>
+
+#include "DmModule/WorkerPool.h"
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/Logging.h"
+
+static Elements::Logging logger = Elements::Logging::getLogger("WorkerPool");
+
+namespace {
+
+// Node of the worker running on this thread
+thread_local int currentNode = -1;
+
+}  // namespace
+
+namespace DmModule {
+
+ WorkerPool::Placement WorkerPool::parsePlacement(const std::string& name) {
+  if (name == "none") {
+    return Placement::NONE;
+  }
+  if (name == "core") {
+    return Placement::CORE;
+  }
+  if (name == "socket") {
+    return Placement::SOCKET;
+  }
+  throw Elements::Exception() << "Unknown worker placement \"" << name << "\", expected none, core or socket";
+ }
+
+ int WorkerPool::getCurrentNode() {
+  return currentNode;
+ }
+
+ WorkerPool::WorkerPool(unsigned nb_workers, Placement placement)
+      : WorkerPool(nb_workers, placement, placement == Placement::NONE ? Topology(std::vector<std::vector<int>>()) : Topology::detect()) {
+ }
+
+ WorkerPool::WorkerPool(unsigned nb_workers, Placement placement, const Topology& topology)
+      : m_placement(placement), m_stopping(false) {
+  if (nb_workers == 0) {
+    if (placement == Placement::NONE) {
+      nb_workers = std::max(1u, std::thread::hardware_concurrency());
+    } else {
+      for (unsigned node = 0; node < topology.getNbNodes(); ++node) {
+        nb_workers += static_cast<unsigned>(topology.getCpus(node).size());
+      }
+    }
+  }
+  unsigned nbNodes = placement == Placement::NONE ? 1 : std::min(nb_workers, topology.getNbNodes());
+  m_nodeTasks.resize(nbNodes);
+  logger.debug() << "Starting " << nb_workers << " worker threads on " << nbNodes << " nodes";
+  m_workers.reserve(nb_workers);
+  for (unsigned i = 0; i < nb_workers; ++i) {
+    // round robin over the nodes, then over the cores of the node
+    unsigned node = i % nbNodes;
+    std::vector<int> cpus;
+    if (placement == Placement::SOCKET) {
+      cpus = topology.getCpus(node);
+    } else if (placement == Placement::CORE) {
+      const std::vector<int>& nodeCpus = topology.getCpus(node);
+      cpus.push_back(nodeCpus[(i / nbNodes) % nodeCpus.size()]);
+    }
+    m_workers.emplace_back(&WorkerPool::workerLoop, this, node, cpus);
+  }
+ }
+
+ WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stopping = true;
+  }
+  m_cond.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+ }
+
+ unsigned WorkerPool::getNbWorkers() const {
+  return static_cast<unsigned>(m_workers.size());
+ }
+
+ unsigned WorkerPool::getNbNodes() const {
+  return static_cast<unsigned>(m_nodeTasks.size());
+ }
+
+ void WorkerPool::enqueue(int node, std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (node < 0 || m_placement == Placement::NONE) {
+      m_tasks.push_back(std::move(task));
+    } else {
+      m_nodeTasks[node].push_back(std::move(task));
+    }
+  }
+  // only the workers of the node can take a placed task
+  if (node < 0 || m_placement == Placement::NONE) {
+    m_cond.notify_one();
+  } else {
+    m_cond.notify_all();
+  }
+ }
+
+ void WorkerPool::workerLoop(unsigned node, std::vector<int> cpus) {
+  if (m_placement != Placement::NONE) {
+    currentNode = static_cast<int>(node);
+    if (!Topology::pinCurrentThread(cpus)) {
+      logger.warn() << "Could not pin a worker thread on node " << node;
+    }
+  }
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      std::deque<std::function<void()>>& own = m_nodeTasks[node];
+      m_cond.wait(lock, [this, &own]() { return m_stopping || !own.empty() || !m_tasks.empty(); });
+      if (own.empty() && m_tasks.empty()) {
+        return;
+      }
+      // tasks of the node first, then the tasks for any node
+      std::deque<std::function<void()>>* queue = own.empty() ? &m_tasks : &own;
+      task = std::move(queue->front());
+      queue->pop_front();
+    }
+    // exceptions are captured by the packaged_task and rethrown by the future
+    task();
+  }
+ }
+
+}  // namespace DmModule
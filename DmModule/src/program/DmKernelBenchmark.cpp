@@ -0,0 +1,302 @@
+/**
+ * @file src/program/DmKernelBenchmark.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include "ElementsKernel/Exception.h"
+#include "ElementsKernel/ProgramHeaders.h"
+
+#include "DmModule/KernelDispatch.h"
+#include "DmModule/Parameters.h"
+#include "DmModule/ReconstructionKernels.h"
+
+using boost::program_options::options_description;
+using boost::program_options::variable_value;
+using namespace DmModule;
+
+namespace po = boost::program_options;
+using namespace std;
+
+namespace {
+
+/*
+ * Reference versions testing the flags inside the loops, as the reconstruction
+ * did before the kernels were specialized. The flags are read through the
+ * Parameters getters, which live in the library: a bool argument would be
+ * loop-invariant and the compiler would unswitch the loops itself.
+ */
+void branchyInpaintStep(double* scale, double* kappaB, const char* mask, size_t nbPixels, double lambda,
+                        Parameters& params) {
+  double sumIn = 0., sumSqIn = 0., sumOut = 0., sumSqOut = 0.;
+  size_t nbIn = 0, nbOut = 0;
+  for (size_t k = 0; k < nbPixels; ++k) {
+    if (fabs(scale[k]) < lambda) {
+      scale[k] = 0.;
+    }
+    if (params.getEqualVarPerScale()) {
+      if (mask[k]) {
+        sumOut += scale[k];
+        sumSqOut += scale[k] * scale[k];
+        ++nbOut;
+      } else {
+        sumIn += scale[k];
+        sumSqIn += scale[k] * scale[k];
+        ++nbIn;
+      }
+    }
+  }
+  if (params.getEqualVarPerScale() && nbIn > 0 && nbOut > 0) {
+    double varIn = sumSqIn / nbIn - (sumIn / nbIn) * (sumIn / nbIn);
+    double varOut = sumSqOut / nbOut - (sumOut / nbOut) * (sumOut / nbOut);
+    if (varIn > 0.) {
+      double factor = sqrt(varOut / varIn);
+      for (size_t k = 0; k < nbPixels; ++k) {
+        if (!mask[k]) {
+          scale[k] *= factor;
+        }
+      }
+    }
+  }
+  for (size_t k = 0; k < nbPixels; ++k) {
+    if (params.getForceBMode() && !mask[k]) {
+      kappaB[k] = 0.;
+    }
+  }
+}
+
+void branchyPack(const double* in1, const double* in2, double* buffer, size_t dim, Parameters& params) {
+  size_t fftXdim = params.get_addBorders() ? 2 * dim : dim, offset = params.get_addBorders() ? dim / 2 : 0;
+  for (size_t y = 0; y < dim; ++y) {
+    for (size_t x = 0; x < dim; ++x) {
+      size_t k = params.get_addBorders() ? (y + offset) * fftXdim + x + offset : y * dim + x;
+      buffer[2 * k] = in1[y * dim + x];
+      buffer[2 * k + 1] = in2[y * dim + x];
+    }
+  }
+}
+
+int branchyRedshiftBin(size_t index, double z, const vector<int>& balancedBin, const vector<double>& zEdges,
+                       Parameters& params) {
+  int zbin;
+  if (params.get_BalancedBins()) {
+    zbin = balancedBin[index];
+  } else {
+    zbin = static_cast<int>(upper_bound(zEdges.begin(), zEdges.end(), z) - zEdges.begin()) - 1;
+    if (zbin >= static_cast<int>(zEdges.size()) - 1) {
+      zbin = -1;
+    }
+  }
+  return zbin;
+}
+
+void branchyCountBins(const vector<double>& z, const vector<int>& balancedBin, const vector<double>& zEdges,
+                      Parameters& params, vector<size_t>& counts) {
+  for (size_t i = 0; i < z.size(); ++i) {
+    int zbin = branchyRedshiftBin(i, z[i], balancedBin, zEdges, params);
+    if (zbin >= 0) {
+      ++counts[zbin];
+    }
+  }
+}
+
+struct InpaintStepKernel {
+  typedef void result_type;
+
+  template <bool ForceBMode, bool EqualVarPerScale>
+  void run() const {
+    Kernels::thresholdScale<EqualVarPerScale>(scale, mask, nbPixels, lambda);
+    Kernels::constrainBModes<ForceBMode>(kappaB, mask, nbPixels);
+  }
+
+  double* scale;
+  double* kappaB;
+  const char* mask;
+  size_t nbPixels;
+  double lambda;
+};
+
+struct PackKernel {
+  typedef void result_type;
+
+  template <bool AddBorders>
+  void run() const {
+    size_t fftXdim = AddBorders ? 2 * dim : dim, offset = AddBorders ? dim / 2 : 0;
+    Kernels::packGrid<AddBorders>(in1, in2, buffer, dim, dim, fftXdim, offset, offset);
+  }
+
+  const double* in1;
+  const double* in2;
+  double* buffer;
+  size_t dim;
+};
+
+struct CountBinsKernel {
+  typedef void result_type;
+
+  template <bool BalancedBins>
+  void run() const {
+    for (size_t i = 0; i < z.size(); ++i) {
+      int zbin = Kernels::redshiftBin<BalancedBins>(i, z[i], balancedBin, zEdges);
+      if (zbin >= 0) {
+        ++counts[zbin];
+      }
+    }
+  }
+
+  const vector<double>& z;
+  const vector<int>& balancedBin;
+  const vector<double>& zEdges;
+  vector<size_t>& counts;
+};
+
+// Parameters holding only the flags of the kernels
+Parameters flagParameters(bool forceBMode, bool equalVarPerScale, bool addBorders, bool balancedBins) {
+  return Parameters(0, 1, 1., 1., {0.}, {0.}, 10, {0.2}, 2.2, balancedBins, 0, equalVarPerScale, forceBMode, 0,
+                    addBorders, 0., 0., 0);
+}
+
+template <typename Function>
+double millisecondsPerCall(Function function, int repeat) {
+  auto start = chrono::steady_clock::now();
+  for (int r = 0; r < repeat; ++r) {
+    function();
+  }
+  chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - start;
+  return elapsed.count() / repeat;
+}
+
+}  // namespace
+
+class DmKernelBenchmark : public Elements::Program {
+
+public:
+
+  options_description defineSpecificProgramOptions() override {
+
+    options_description options {};
+   options.add_options()
+   ("map_size", po::value<int>()->default_value(512), "Number of pixels on a side of the benchmark maps");
+   options.add_options()
+   ("repeat", po::value<int>()->default_value(50), "Number of calls timed for each kernel");
+
+    return options;
+  }
+
+  Elements::ExitCode mainMethod(std::map<std::string, variable_value>& args) override {
+
+    Elements::Logging logger = Elements::Logging::getLogger("DmKernelBenchmark");
+
+    size_t dim = static_cast<size_t>(args["map_size"].as<int>());
+    int repeat = args["repeat"].as<int>();
+    size_t nbPixels = dim * dim;
+    logger.info() << "Timing the reconstruction kernels on " << dim << "x" << dim << " maps, "
+                  << repeat << " calls each";
+
+    // Random coefficients and a mask with 20% of empty pixels
+    mt19937_64 generator(12345);
+    normal_distribution<double> gaussian;
+    uniform_real_distribution<double> uniform;
+    vector<double> coefficients(nbPixels), kappaB(nbPixels), map1(nbPixels), map2(nbPixels);
+    vector<char> mask(nbPixels);
+    for (size_t k = 0; k < nbPixels; ++k) {
+      coefficients[k] = gaussian(generator);
+      kappaB[k] = gaussian(generator);
+      map1[k] = gaussian(generator);
+      map2[k] = gaussian(generator);
+      mask[k] = uniform(generator) < 0.8 ? 1 : 0;
+    }
+    vector<double> scale(nbPixels), kappaBWork(nbPixels), buffer(8 * nbPixels, 0.);
+
+    for (int flags = 0; flags < 4; ++flags) {
+      bool forceBMode = (flags & 1) != 0, equalVarPerScale = (flags & 2) != 0;
+      Parameters params = flagParameters(forceBMode, equalVarPerScale, false, false);
+      double branchy = millisecondsPerCall([&]() {
+        scale = coefficients;
+        kappaBWork = kappaB;
+        branchyInpaintStep(scale.data(), kappaBWork.data(), mask.data(), nbPixels, 0.5, params);
+      }, repeat);
+      double specialized = millisecondsPerCall([&]() {
+        scale = coefficients;
+        kappaBWork = kappaB;
+        dispatchKernel(InpaintStepKernel{scale.data(), kappaBWork.data(), mask.data(), nbPixels, 0.5},
+                       forceBMode, equalVarPerScale);
+      }, repeat);
+      logger.info() << "inpainting step ForceBMode=" << forceBMode << " EqualVarPerScale=" << equalVarPerScale
+                    << ": branchy " << branchy << " ms, specialized " << specialized << " ms, speedup "
+                    << branchy / specialized;
+    }
+
+    for (int addBorders = 0; addBorders < 2; ++addBorders) {
+      Parameters params = flagParameters(false, false, addBorders != 0, false);
+      double branchy = millisecondsPerCall([&]() {
+        branchyPack(map1.data(), map2.data(), buffer.data(), dim, params);
+      }, repeat);
+      double specialized = millisecondsPerCall([&]() {
+        dispatchKernel(PackKernel{map1.data(), map2.data(), buffer.data(), dim}, addBorders);
+      }, repeat);
+      logger.info() << "FFT buffer copy addBorders=" << addBorders << ": branchy " << branchy
+                    << " ms, specialized " << specialized << " ms, speedup " << branchy / specialized;
+    }
+
+    // Redshift bins of one galaxy per pixel, 10 bins over [0.2, 2.2[ or the bins of the
+    // balanced ranks; both versions must find the same number of galaxies in every bin
+    vector<double> z(nbPixels), zEdges;
+    vector<int> balancedBin(nbPixels);
+    for (size_t k = 0; k < nbPixels; ++k) {
+      z[k] = 2.5 * uniform(generator);
+      balancedBin[k] = static_cast<int>(uniform(generator) * 11) - 1;
+    }
+    for (int b = 0; b <= 10; ++b) {
+      zEdges.push_back(0.2 + 0.2 * b);
+    }
+    for (int balancedBins = 0; balancedBins < 2; ++balancedBins) {
+      vector<size_t> branchyCounts(10, 0), specializedCounts(10, 0);
+      Parameters params = flagParameters(false, false, false, balancedBins != 0);
+      double branchy = millisecondsPerCall([&]() {
+        branchyCountBins(z, balancedBin, zEdges, params, branchyCounts);
+      }, repeat);
+      double specialized = millisecondsPerCall([&]() {
+        dispatchKernel(CountBinsKernel{z, balancedBin, zEdges, specializedCounts}, balancedBins);
+      }, repeat);
+      if (branchyCounts != specializedCounts) {
+        throw Elements::Exception() << "The specialized redshift binning differs from the branchy one with "
+                                    << "BalancedBins=" << balancedBins;
+      }
+      logger.info() << "redshift binning BalancedBins=" << balancedBins << ": branchy " << branchy
+                    << " ms, specialized " << specialized << " ms, speedup " << branchy / specialized;
+    }
+
+    return Elements::ExitCode::OK;
+  }
+
+};
+
+MAIN_FOR(DmKernelBenchmark)
@@ -0,0 +1,132 @@
+/**
+ * @file src/program/DmPlacementBenchmark.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <chrono>
+#include <future>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include "ElementsKernel/ProgramHeaders.h"
+
+#include "DmModule/MapMaker.h"
+#include "DmModule/MassMapping.h"
+#include "DmModule/Parameters.h"
+#include "DmModule/ShearCatalog.h"
+#include "DmModule/WorkerPool.h"
+
+using boost::program_options::options_description;
+using boost::program_options::variable_value;
+using namespace DmModule;
+
+namespace po = boost::program_options;
+using namespace std;
+
+namespace {
+
+// Galaxies uniformly spread over a patch of one degree centered on (10, 20)
+ShearCatalog makeCatalog(size_t nbGalaxies, unsigned seed) {
+  mt19937_64 generator(seed);
+  uniform_real_distribution<double> position(-0.5, 0.5), redshift(0.2, 1.8);
+  normal_distribution<double> shear(0., 0.3);
+  vector<double> ra(nbGalaxies), dec(nbGalaxies), gamma1(nbGalaxies), gamma2(nbGalaxies), weight(nbGalaxies, 1.),
+                 z(nbGalaxies);
+  for (size_t k = 0; k < nbGalaxies; ++k) {
+    ra[k] = 10. + position(generator);
+    dec[k] = 20. + position(generator);
+    gamma1[k] = shear(generator);
+    gamma2[k] = shear(generator);
+    z[k] = redshift(generator);
+  }
+  return ShearCatalog(ra, dec, gamma1, gamma2, weight, z);
+}
+
+}  // namespace
+
+class DmPlacementBenchmark : public Elements::Program {
+
+public:
+
+  options_description defineSpecificProgramOptions() override {
+
+    options_description options {};
+   options.add_options()
+   ("nb_products", po::value<int>()->default_value(32), "Number of products binned and reconstructed per placement");
+   options.add_options()
+   ("nb_galaxies", po::value<int>()->default_value(200000), "Number of galaxies of the catalog of each product");
+   options.add_options()
+   ("pixel_size", po::value<double>()->default_value(0.5), "Pixel size in arcminutes of the one degree patches");
+   options.add_options()
+   ("nb_threads", po::value<int>()->default_value(0), "Number of threads, 0 for one per core");
+
+    return options;
+  }
+
+  Elements::ExitCode mainMethod(std::map<std::string, variable_value>& args) override {
+
+    Elements::Logging logger = Elements::Logging::getLogger("DmPlacementBenchmark");
+
+    int nbProducts = args["nb_products"].as<int>();
+    size_t nbGalaxies = static_cast<size_t>(args["nb_galaxies"].as<int>());
+    unsigned nbThreads = static_cast<unsigned>(args["nb_threads"].as<int>());
+    Parameters param(0, 1, static_cast<float>(args["pixel_size"].as<double>()), 1., {10.}, {20.}, 2, {0., 1.}, 2.,
+                     0, 20, 0, 1, 0, 0, 0.5, 1., 0);
+
+    Topology topology = Topology::detect();
+    logger.info() << "Binning and reconstructing " << nbProducts << " products of " << nbGalaxies
+                  << " galaxies on " << topology.getNbNodes() << " NUMA nodes";
+
+    double reference = 0.;
+    for (const char* name : {"none", "socket", "core"}) {
+      WorkerPool pool(nbThreads, WorkerPool::parsePlacement(name));
+      auto start = chrono::steady_clock::now();
+      vector<future<void>> results;
+      for (int p = 0; p < nbProducts; ++p) {
+        // the catalog and the maps of a product are allocated by the worker processing it
+        results.push_back(pool.submitOn(static_cast<unsigned>(p), [&param, nbGalaxies, p]() {
+          ShearCatalog catalog = makeCatalog(nbGalaxies, static_cast<unsigned>(p));
+          MapMaker mapMaker(param);
+          MassMapping massMapping(param);
+          massMapping.reconstruct(mapMaker.makeShearMaps(catalog), nullptr, mapMaker.getZEdges().size() - 1);
+        }));
+      }
+      for (auto& result : results) {
+        result.get();
+      }
+      chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+      double throughput = nbProducts / elapsed.count();
+      if (reference == 0.) {
+        reference = throughput;
+      }
+      logger.info() << "placement " << name << ": " << pool.getNbWorkers() << " threads, " << throughput
+                    << " products/s, speedup " << throughput / reference;
+    }
+
+    return Elements::ExitCode::OK;
+  }
+
+};
+
+MAIN_FOR(DmPlacementBenchmark)
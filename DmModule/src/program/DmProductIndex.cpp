@@ -0,0 +1,90 @@
+/**
+ * @file src/program/DmProductIndex.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+#include "ElementsKernel/ProgramHeaders.h"
+
+#include "DmModule/ProductIndex.h"
+
+using boost::program_options::options_description;
+using boost::program_options::variable_value;
+using namespace DmModule;
+
+namespace po = boost::program_options;
+using namespace std;
+
+class DmProductIndex : public Elements::Program {
+
+public:
+
+  options_description defineSpecificProgramOptions() override {
+
+    options_description options {};
+   options.add_options()
+   ("workdir", po::value<string>()->default_value(""), "The root working directory where the data is located");
+   options.add_options()
+   ("nb_threads", po::value<int>()->default_value(0), "Number of threads parsing the products, 0 for one per core");
+   options.add_options()
+   ("product_type", po::value<string>()->default_value(""), "List the products of this type");
+   options.add_options()
+   ("data_file", po::value<string>()->default_value(""), "List the products referencing this file of workdir/data");
+
+    return options;
+  }
+
+  Elements::ExitCode mainMethod(std::map<std::string, variable_value>& args) override {
+
+    Elements::Logging logger = Elements::Logging::getLogger("DmProductIndex");
+
+    ProductIndex index(args["workdir"].as<string>());
+    size_t nbParsed = index.update(args["nb_threads"].as<int>());
+    index.save();
+    logger.info() << "Index " << index.getIndexFile() << " of " << index.size() << " products, " << nbParsed
+                  << " products parsed";
+
+    vector<const ProductIndex::Product*> products;
+    auto product_type = args["product_type"].as<string>();
+    auto data_file = args["data_file"].as<string>();
+    if (!product_type.empty()) {
+      products = index.findByType(product_type);
+    } else if (!data_file.empty()) {
+      products = index.findByDataFile(data_file);
+    }
+    for (const auto* product : products) {
+      logger.info() << product->file << " " << product->type;
+      for (const auto& dataFile : product->dataFiles) {
+        logger.info() << "    " << dataFile.name << (dataFile.exists ? "" : " (missing)") << " "
+                      << dataFile.size << " bytes";
+      }
+    }
+
+    return Elements::ExitCode::OK;
+  }
+
+};
+
+MAIN_FOR(DmProductIndex)
@@ -21,8 +21,16 @@
  *
  */
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <iomanip>
+#include <iterator>
 #include <map>
+#include <sstream>
 #include <string>
+#include <vector>
 
 #include <boost/program_options.hpp>
 #include "ElementsKernel/ProgramHeaders.h"
@@ -31,7 +39,17 @@
 #include "DmModule/DmInput.h"
 #include "DmModule/DmOutput.h"
 
+#include "DmModule/FftPlanCache.h"
+#include "DmModule/MapMaker.h"
+#include "DmModule/MassMapping.h"
+#include "DmModule/NoiseResampler.h"
+#include "DmModule/OutputCompressor.h"
 #include "DmModule/Parameters.h"
+#include "DmModule/ParameterSweep.h"
+#include "DmModule/ProcessExecutor.h"
+#include "DmModule/ProductIndex.h"
+#include "DmModule/ShearCatalog.h"
+#include "DmModule/WorkerPool.h"
 
 using boost::program_options::options_description;
 using boost::program_options::variable_value;
@@ -56,6 +74,44 @@ public:
    ("parameter_file", po::value<string>()->default_value(""), "The input parameter file in xml format");
    options.add_options()
    ("output_xml_file", po::value<string>()->default_value(""), "The output file in xml format");
+   options.add_options()
+   ("sweep_grid", po::value<string>()->default_value(""),
+    "Parameter sweep grid, e.g. \"sigmaGauss=1,2;NInpaint=0,100\" (reconstruction done in the library)");
+   options.add_options()
+   ("nb_threads", po::value<int>()->default_value(0), "Number of threads, 0 for one per core");
+   options.add_options()
+   ("nb_output_threads", po::value<int>()->default_value(2),
+    "Number of threads compressing, and of threads writing, the outputs of a parameter sweep");
+   options.add_options()
+   ("compression", po::value<string>()->default_value("none"),
+    "Compression of the output maps: none, rice (lossy, quantized RICE_1) or gzip (lossless GZIP_2), "
+    "the XML products are written uncompressed");
+   options.add_options()
+   ("memory_budget", po::value<int>()->default_value(0),
+    "Memory available to the sweep jobs in MB, 0 for 80% of the available memory");
+   options.add_options()
+   ("placement", po::value<string>()->default_value("none"),
+    "Pinning of the sweep threads: none, core (one core each) or socket (the CPUs of a NUMA node)");
+   options.add_options()
+   ("stage_timeout", po::value<int>()->default_value(0),
+    "Time limit of each run of the external map maker in seconds, 0 for no limit");
+   options.add_options()
+   ("reconstruction", po::value<string>()->default_value("external"),
+    "Reconstruction of the convergence: external (LE3_2D_MASS_WL_CartesianMapMaker) or library");
+   options.add_options()
+   ("convergence_tolerance", po::value<double>()->default_value(0.),
+    "Relative change of the convergence stopping the in-library inpainting and reduced shear iterations, "
+    "e.g. 1e-4, 0 to run all of them");
+   options.add_options()
+   ("noise_seed", po::value<int>()->default_value(0),
+    "Seed of the nbSamples noise realizations of the in-library reconstruction, a given seed gives the same "
+    "realizations for any number of threads");
+   options.add_options()
+   ("fft_wisdom", po::value<string>()->default_value(""),
+    "FFTW wisdom file loaded at start and saved at the end, relative to the workdir, none when empty");
+   options.add_options()
+   ("fft_effort", po::value<string>()->default_value("estimate"),
+    "FFT planner effort: estimate, measure or patient, measured plans are worth it with a wisdom file");
 
     return options;
   }
@@ -72,30 +128,47 @@ public:
     fs::path data_dir {workdir / "data"};
 
     //
-    // Check for the existence of the input XML product file and
-    //			throw an Elements exception if it does not exist
+    // Index of the products of the working directory, it is scanned again when
+    // products were added or removed since the last run, otherwise only the
+    // input products are read again when they changed
     //
     fs::path in_xml_file {args["input_xml_file"].as<string>()};
-    if (!fs::exists(workdir / in_xml_file)) {
-    	throw Elements::Exception() << "Input XML data product " << workdir / in_xml_file << " not found";
+    fs::path parameter_file {args["parameter_file"].as<string>()};
+    ProductIndex index(workdir);
+    // the index and the programs run in the workdir take the paths relative to it
+    auto relative = [&workdir](const fs::path& file) {
+      return workdir.empty() ? file : fs::relative(file, workdir);
+    };
+    if (index.isStale()) {
+      index.update(args["nb_threads"].as<int>());
+    } else {
+      index.refresh(in_xml_file);
+      index.refresh(parameter_file);
     }
+
+    //
+    // Resolve the input XML product file through the index and
+    //			throw an Elements exception if it does not exist
+    //
+    const ProductIndex::Product& input = index.resolve(in_xml_file, "DpdTwoDMassLensMCCatalog");
     logger.info() << "Using file " << workdir / in_xml_file << " as DM input product";
 
     // Read inputs from the XML file i.e.:
-    // 		the filename of the FITS catalog
+    // 		the filename of the FITS catalog, recorded in the index
 
-    DmInput in_xml = DmInput::readFile(workdir / in_xml_file);
+    DmInput in_xml = input.dataFiles.empty() ? DmInput::readFile(workdir / in_xml_file)
+                                             : DmInput(input.dataFiles.front().name);
+    if (!input.dataFiles.empty() && !input.dataFiles.front().exists) {
+      throw Elements::Exception() << "FITS catalog " << data_dir / in_xml.getFitsCatalogFilename() << " not found";
+    }
 
     logger.info() << "Using file " << data_dir / in_xml.getFitsCatalogFilename() << " as FITS input catalog";
     std::string inCatalog = ("data" / in_xml.getFitsCatalogFilename()).string(); 
     //
-    // Check for the existence of the input parameter XML file and
+    // Resolve the input parameter XML file through the index and
     //			throw an Elements exception if it does not exist
     //
-    fs::path parameter_file {args["parameter_file"].as<string>()};
-    if (!fs::exists(workdir / parameter_file)) {
-    	throw Elements::Exception() << "Input XML data product " << workdir / parameter_file << " not found";
-    }
+    index.resolve(parameter_file, "DpdTwoDMassParamsConvergencePatch");
     logger.info() << "Using file " << workdir / parameter_file << " as DM input parameter product";
 
     //
@@ -103,14 +176,166 @@ public:
     //
     Parameters param;
     param = param.readParameterFile(workdir / parameter_file);
+    param.setConvergenceTolerance(args["convergence_tolerance"].as<double>());
+
+    //
+    // The FFT plans of the in-library reconstruction are shared by all the
+    // patches, the wisdom of the previous runs saves their planning
+    //
+    FftPlanCache& fftPlans = FftPlanCache::getInstance();
+    fftPlans.setEffort(FftPlanCache::parseEffort(args["fft_effort"].as<string>()));
+    fs::path fft_wisdom {args["fft_wisdom"].as<string>()};
+    if (!fft_wisdom.empty()) {
+      fftPlans.importWisdom(workdir / fft_wisdom);
+    }
+
+    //
+    // Sweep mode: bin the catalog once and reconstruct every grid point
+    //
+    auto compression = OutputCompressor::parseFormat(args["compression"].as<string>());
+    auto sweep_grid = args["sweep_grid"].as<string>();
+    if (!sweep_grid.empty()) {
+      ShearCatalog catalog = ShearCatalog::readFits(data_dir / in_xml.getFitsCatalogFilename());
+      ParameterSweep sweep(param, sweep_grid);
+      auto products = sweep.run(catalog, workdir, args["output_xml_file"].as<string>(), args["nb_threads"].as<int>(),
+                                compression, static_cast<std::size_t>(args["memory_budget"].as<int>()) * 1024 * 1024,
+                                WorkerPool::parsePlacement(args["placement"].as<string>()),
+                                args["nb_output_threads"].as<int>());
+
+      logger.info() << products.size() << " DM output products created in: " << workdir;
+      if (!fft_wisdom.empty()) {
+        fftPlans.exportWisdom(workdir / fft_wisdom);
+      }
+      for (const auto& product : products) {
+        index.refresh(relative(product));
+      }
+      index.save();
+
+      logger.info("Done!");
+
+      logger.info("#");
+      logger.info("# Exiting mainMethod()");
+      logger.info("#");
+
+      return Elements::ExitCode::OK;
+    }
 
     //
     // Execute the processing function algorithm
     //
-     fs::path out_fits_file = fs::path("DevWS_ShearMap.fits");
-     system(("E-Run LE3_2D_MASS_WL_KS 2.5 LE3_2D_MASS_WL_CartesianMapMaker --workdir=" + workdir.string() + " --paramFile=" +
-           parameter_file.string() + " --input_ShearCatalog=" + inCatalog + " --outShearMap="
-           + out_fits_file.string()).c_str());
+    OutputCompressor compressor(compression, args["nb_threads"].as<int>());
+    fs::path out_xml_file {args["output_xml_file"].as<string>()};
+    fs::path out_fits_file = fs::path("DevWS_ShearMap.fits");
+    int nbResamples = 0;
+    auto reconstruction = args["reconstruction"].as<string>();
+    if (reconstruction == "library") {
+      ShearCatalog catalog = ShearCatalog::readFits(data_dir / in_xml.getFitsCatalogFilename());
+      MapMaker mapMaker(param);
+      std::vector<MassMapping::Iterations> iterations;
+      std::vector<PatchMap> convergenceMaps = MassMapping(param).reconstruct(mapMaker.makeShearMaps(catalog),
+                                                                            &iterations,
+                                                                            mapMaker.getZEdges().size() - 1);
+      for (std::size_t m = 0; m < iterations.size(); ++m) {
+        logger.info() << "Map " << m << ": " << iterations[m].inpainting << " inpainting iterations, "
+                      << iterations[m].reducedShear << " reduced shear corrections";
+      }
+      //
+      // Noise realizations with randomly rotated galaxies, their mean and variance
+      // maps are written after the convergence maps
+      //
+      if (param.getNSamples() > 0) {
+        WorkerPool pool(args["nb_threads"].as<int>());
+        NoiseResampler resampler(param, catalog, static_cast<std::uint64_t>(args["noise_seed"].as<int>()));
+        NoiseResampler::Statistics noise = resampler.resample(pool);
+        nbResamples = noise.nbRealizations;
+        std::move(noise.mean.begin(), noise.mean.end(), std::back_inserter(convergenceMaps));
+        std::move(noise.variance.begin(), noise.variance.end(), std::back_inserter(convergenceMaps));
+      }
+      // the maps are named after the output product, as the products of a sweep
+      out_fits_file = compressor.writeMaps(data_dir / (out_xml_file.stem().string() + ".fits"), convergenceMaps)
+                          .filename();
+      if (!fft_wisdom.empty()) {
+        fftPlans.exportWisdom(workdir / fft_wisdom);
+      }
+    } else if (reconstruction == "external") {
+      //
+      // The map maker runs once per patch, nb_threads runs at a time, when the parameter
+      // file holds several patches. Every run gets its own product, which records the
+      // exit status of the run in its header
+      //
+      std::vector<fs::path> param_files {parameter_file}, xml_files {out_xml_file}, fits_files {out_fits_file};
+      std::vector<fs::path> patch_files = Parameters::writePatchParameterFiles(workdir / parameter_file);
+      if (!patch_files.empty()) {
+        param_files.clear();
+        xml_files.clear();
+        fits_files.clear();
+        for (std::size_t i = 0; i < patch_files.size(); ++i) {
+          std::ostringstream suffix;
+          suffix << "_" << std::setw(4) << std::setfill('0') << i;
+          param_files.push_back(relative(patch_files[i]));
+          xml_files.push_back(out_xml_file.parent_path() / (out_xml_file.stem().string() + suffix.str() + ".xml"));
+          fits_files.push_back(out_fits_file.stem().string() + suffix.str() + ".fits");
+        }
+      }
+
+      ProcessExecutor executor(args["nb_threads"].as<int>());
+      std::vector<std::future<ProcessExecutor::Result>> stages;
+      for (std::size_t i = 0; i < param_files.size(); ++i) {
+        stages.push_back(executor.submit({"E-Run", "LE3_2D_MASS_WL_KS", "2.5", "LE3_2D_MASS_WL_CartesianMapMaker",
+                                          "--workdir=" + workdir.string(), "--paramFile=" + param_files[i].string(),
+                                          "--input_ShearCatalog=" + inCatalog,
+                                          "--outShearMap=" + fits_files[i].string()},
+                                         std::chrono::seconds(args["stage_timeout"].as<int>())));
+      }
+
+      std::size_t nbFailed = 0;
+      for (std::size_t i = 0; i < stages.size(); ++i) {
+        ProcessExecutor::Result result {-1, 0, false, "", "", std::chrono::milliseconds(0)};
+        try {
+          result = stages[i].get();
+        } catch (const Elements::Exception& e) {
+          result.err = e.what();
+        }
+        if (!result.out.empty()) {
+          logger.debug() << "LE3_2D_MASS_WL_CartesianMapMaker output for " << param_files[i] << ":\n" << result.out;
+        }
+        //
+        // The product of a failed run points to the maps it should have made, its
+        // ExitStatusCode is ERROR
+        //
+        fs::path fits_file = fits_files[i];
+        if (result.succeeded()) {
+          fits_file = compressor.compressFits(data_dir / fits_file).filename();
+        } else {
+          ++nbFailed;
+          logger.error() << "LE3_2D_MASS_WL_CartesianMapMaker failed for " << param_files[i] << " with "
+                         << result.describe() << ": " << result.err;
+        }
+        DmOutput::createOutputXml(workdir / xml_files[i], fits_file, 0, result.succeeded() ? "OK" : "ERROR");
+        index.refresh(xml_files[i]);
+      }
+      for (const auto& patch_file : patch_files) {
+        index.refresh(relative(patch_file));
+      }
+      index.save();
+
+      if (nbFailed > 0) {
+        throw Elements::Exception() << nbFailed << " of " << stages.size()
+                                    << " LE3_2D_MASS_WL_CartesianMapMaker runs failed, their products are in "
+                                    << workdir << " with the ERROR exit status";
+      }
+      logger.info() << xml_files.size() << " DM output products created in: " << workdir;
+
+      logger.info("Done!");
+
+      logger.info("#");
+      logger.info("# Exiting mainMethod()");
+      logger.info("#");
+
+      return Elements::ExitCode::OK;
+    } else {
+      throw Elements::Exception() << "Unknown reconstruction \"" << reconstruction << "\", expected external or library";
+    }
 
   // --------------------------------------------------------------
   // Exercise
@@ -118,11 +343,11 @@ public:
     //
     // Generate the output XML product
     //
-    auto out_xml_file = args["output_xml_file"].as<string>();
-
-    DmOutput::createOutputXml(workdir / out_xml_file, out_fits_file);
+    DmOutput::createOutputXml(workdir / out_xml_file, out_fits_file, nbResamples);
 
     logger.info() << "DM output products created in: " << workdir / out_xml_file;
+    index.refresh(out_xml_file);
+    index.save();
 
     logger.info("Done!");
 
@@ -0,0 +1,166 @@
+/**
+ * @file src/python/DmBindings.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <boost/make_shared.hpp>
+#include <boost/python.hpp>
+#include <boost/python/numpy.hpp>
+
+#include "DmModule/DmInput.h"
+#include "DmModule/DmOutput.h"
+#include "DmModule/Parameters.h"
+
+namespace bp = boost::python;
+namespace np = boost::python::numpy;
+
+using DmModule::DmInput;
+using DmModule::DmOutput;
+using DmModule::Parameters;
+
+namespace {
+
+/**
+ * @class ScopedGILRelease
+ * @brief Releases the Python GIL while the XML parsing runs in C++
+ */
+class ScopedGILRelease {
+public:
+  ScopedGILRelease() : m_state(PyEval_SaveThread()) { }
+  ~ScopedGILRelease() { PyEval_RestoreThread(m_state); }
+private:
+  PyThreadState* m_state;
+};
+
+/*
+ * Wraps a vector owned by a Parameters instance in a NumPy array without copying.
+ * The const overload of from_data gives a read-only array, and the Python Parameters
+ * object is kept as the array base so the C++ storage outlives the view.
+ */
+np::ndarray readOnlyView(const bp::object& owner, const std::vector<double>& values) {
+  return np::from_data(values.data(), np::dtype::get_builtin<double>(),
+                       bp::make_tuple(values.size()), bp::make_tuple(sizeof(double)), owner);
+}
+
+std::vector<double> toVector(const bp::object& sequence) {
+  std::vector<double> values;
+  for (bp::ssize_t i = 0; i < bp::len(sequence); ++i) {
+    values.push_back(bp::extract<double>(sequence[i]));
+  }
+  return values;
+}
+
+/*
+ * Parameters of the patches centred on mapCenterX/mapCenterY with the redshift bins
+ * starting at zMin, the other parameters take the values of the default constructor
+ */
+boost::shared_ptr<Parameters> makeParameters(const bp::object& mapCenterX, const bp::object& mapCenterY,
+                                             const bp::object& zMin, double zMax) {
+  Parameters defaults;
+  std::vector<double> centerX = toVector(mapCenterX), centerY = toVector(mapCenterY), bins = toVector(zMin);
+  int nbPatches = static_cast<int>(centerX.size()), nbZBins = static_cast<int>(bins.size());
+  return boost::make_shared<Parameters>(defaults.getNItReducedShear(), nbPatches, defaults.getPixelsize() * 60.,
+      defaults.getPatchWidth(), std::move(centerX), std::move(centerY), nbZBins, std::move(bins), zMax,
+      defaults.get_BalancedBins(), defaults.getNInpaint(), defaults.getEqualVarPerScale(), defaults.getForceBMode(),
+      defaults.getnbScales(), defaults.get_addBorders(), defaults.getRSSigmaGauss(), defaults.getSigmaGauss(),
+      defaults.getNSamples(), defaults.getRSThreshold(), defaults.getThreshold());
+}
+
+np::ndarray getZMin(const bp::object& self) {
+  Parameters& param = bp::extract<Parameters&>(self);
+  return readOnlyView(self, param.getZMin());
+}
+
+np::ndarray getMapCenterX(const bp::object& self) {
+  Parameters& param = bp::extract<Parameters&>(self);
+  return readOnlyView(self, param.getMapCenterX());
+}
+
+np::ndarray getMapCenterY(const bp::object& self) {
+  Parameters& param = bp::extract<Parameters&>(self);
+  return readOnlyView(self, param.getMapCenterY());
+}
+
+Parameters readParameterFile(Parameters& self, const std::string& parameter_file) {
+  ScopedGILRelease release;
+  return self.readParameterFile(parameter_file);
+}
+
+DmInput readFile(const std::string& in_xml_filename) {
+  ScopedGILRelease release;
+  return DmInput::readFile(in_xml_filename);
+}
+
+std::string getFitsCatalogFilename(const DmInput& self) {
+  return self.getFitsCatalogFilename().string();
+}
+
+void createOutputXml(const std::string& out_xml_filename, const std::string& fits_out_filename) {
+  ScopedGILRelease release;
+  DmOutput::createOutputXml(out_xml_filename, fits_out_filename);
+}
+
+}  // namespace
+
+BOOST_PYTHON_MODULE(DmBindings) {
+
+  np::initialize();
+
+  bp::class_<DmInput>("DmInput", bp::no_init)
+      .def("readFile", &readFile)
+      .staticmethod("readFile")
+      .def("getFitsCatalogFilename", &getFitsCatalogFilename);
+
+  bp::class_<DmOutput>("DmOutput", bp::no_init)
+      .def("createOutputXml", &createOutputXml,
+           (bp::arg("out_xml_filename"), bp::arg("fits_out_filename")))
+      .staticmethod("createOutputXml");
+
+  bp::class_<Parameters>("Parameters", bp::init<>())
+      .def("__init__", bp::make_constructor(&makeParameters, bp::default_call_policies(),
+           (bp::arg("mapCenterX"), bp::arg("mapCenterY"), bp::arg("zMin"), bp::arg("zMax") = 10.)))
+      .def("readParameterFile", &readParameterFile)
+      .def("getZMin", &getZMin)
+      .def("getZMax", &Parameters::getZMax)
+      .def("getPixelsize", &Parameters::getPixelsize)
+      .def("getSigmaGauss", &Parameters::getSigmaGauss)
+      .def("getRSSigmaGauss", &Parameters::getRSSigmaGauss)
+      .def("getThreshold", &Parameters::getThreshold)
+      .def("getRSThreshold", &Parameters::getRSThreshold)
+      .def("getnbZBins", &Parameters::getnbZBins)
+      .def("getnbPatches", &Parameters::getnbPatches)
+      .def("getnbScales", &Parameters::getnbScales)
+      .def("getNInpaint", &Parameters::getNInpaint)
+      .def("getNItReducedShear", &Parameters::getNItReducedShear)
+      .def("get_addBorders", &Parameters::get_addBorders)
+      .def("getEqualVarPerScale", &Parameters::getEqualVarPerScale)
+      .def("getForceBMode", &Parameters::getForceBMode)
+      .def("getPatchWidth", &Parameters::getPatchWidth)
+      .def("getMapCenterX", &getMapCenterX)
+      .def("getMapCenterY", &getMapCenterY)
+      .def("getNSamples", &Parameters::getNSamples)
+      .def("get_BalancedBins", &Parameters::get_BalancedBins)
+      .def("getConvergenceTolerance", &Parameters::getConvergenceTolerance)
+      .def("setConvergenceTolerance", &Parameters::setConvergenceTolerance);
+}
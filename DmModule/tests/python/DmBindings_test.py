@@ -0,0 +1,88 @@
+#
+# Copyright (C) 2012-2020 Euclid Science Ground Segment
+#
+# This library is free software; you can redistribute it and/or modify it under
+# the terms of the GNU Lesser General Public License as published by the Free
+# Software Foundation; either version 3.0 of the License, or (at your option)
+# any later version.
+#
+# This library is distributed in the hope that it will be useful, but WITHOUT
+# ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+# details.
+#
+# You should have received a copy of the GNU Lesser General Public License
+# along with this library; if not, write to the Free Software Foundation, Inc.,
+# 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+#
+
+
+"""
+File: tests/python/DmBindings_test.py
+
+Created on: 10/19/26
+Author: user
+"""
+
+import gc
+
+import numpy
+import pytest
+
+from DmModule.DmBindings import Parameters
+
+CENTER_X = [10., 20.5, 31.]
+CENTER_Y = [-5., 0.25, 7.]
+Z_MIN = [0.2, 0.6, 1.1, 1.7]
+
+
+def make_parameters():
+    return Parameters(CENTER_X, CENTER_Y, Z_MIN, zMax=2.5)
+
+
+class TestDmBindings(object):
+
+    def test_values(self):
+        param = make_parameters()
+        assert param.getnbPatches() == len(CENTER_X)
+        assert param.getnbZBins() == len(Z_MIN)
+        assert param.getZMax() == 2.5
+        for view, expected in ((param.getZMin(), Z_MIN),
+                               (param.getMapCenterX(), CENTER_X),
+                               (param.getMapCenterY(), CENTER_Y)):
+            assert view.dtype == numpy.float64
+            assert view.shape == (len(expected),)
+            assert view.tolist() == expected
+
+    def test_zero_copy(self):
+        param = make_parameters()
+        first = param.getZMin()
+        second = param.getZMin()
+        # both views are on the vector of the Parameters object
+        assert first.ctypes.data == second.ctypes.data
+        assert first.base is param
+        assert second.base is param
+
+    def test_read_only(self):
+        param = make_parameters()
+        view = param.getMapCenterX()
+        assert not view.flags.writeable
+        with pytest.raises(ValueError):
+            view[0] = 0.
+        with pytest.raises(ValueError):
+            view.flags.writeable = True
+        assert param.getMapCenterX().tolist() == CENTER_X
+
+    def test_base_keeps_parameters_alive(self):
+        param = make_parameters()
+        views = [param.getZMin(), param.getMapCenterX(), param.getMapCenterY()]
+        del param
+        gc.collect()
+        # new vectors would reuse the memory of a freed Parameters
+        others = [Parameters([0.] * 3, [0.] * 3, [0.] * 4) for _ in range(10)]
+        assert others[0].getZMin().tolist() == [0.] * 4
+        assert isinstance(views[0].base, Parameters)
+        assert views[0].tolist() == Z_MIN
+        assert views[1].tolist() == CENTER_X
+        assert views[2].tolist() == CENTER_Y
+        assert views[0].base.getnbZBins() == len(Z_MIN)
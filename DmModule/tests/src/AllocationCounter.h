@@ -0,0 +1,228 @@
+/**
+ * @file tests/src/AllocationCounter.h
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+#ifndef _DMMODULE_TESTS_ALLOCATIONCOUNTER_H
+#define _DMMODULE_TESTS_ALLOCATIONCOUNTER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+/*
+ * Counting of the heap allocations for the allocation budgets of the tests.
+ *
+ * This header replaces the global operator new and delete, all their forms
+ * including the aligned ones: it must be included in a single source file of a
+ * test executable. The allocations of all the threads are counted.
+ */
+
+namespace DmModule {
+namespace Testing {
+
+struct AllocationStatistics {
+  std::atomic<std::size_t> allocations;
+  std::atomic<std::size_t> deallocations;
+  std::atomic<std::size_t> bytes;
+};
+
+inline AllocationStatistics& allocationStatistics() {
+  // zero initialized before any allocation
+  static AllocationStatistics statistics;
+  return statistics;
+}
+
+/**
+ * @class AllocationCounter
+ * @brief Heap allocations made since the construction of the counter
+ */
+class AllocationCounter {
+
+public:
+
+  AllocationCounter()
+      : m_allocations(allocationStatistics().allocations), m_deallocations(allocationStatistics().deallocations),
+        m_bytes(allocationStatistics().bytes) {
+  }
+
+  /**
+   * @brief   function to return the number of allocations
+   * @return  number of calls to operator new
+   */
+  std::size_t getAllocations() const { return allocationStatistics().allocations - m_allocations; }
+
+  /**
+   * @brief   function to return the allocated memory
+   * @return  bytes requested to operator new
+   */
+  std::size_t getBytes() const { return allocationStatistics().bytes - m_bytes; }
+
+  /**
+   * @brief   function to return the allocations which were not freed
+   * @return  allocations minus deallocations, negative when older blocks were freed
+   */
+  long getLive() const {
+    return static_cast<long>(getAllocations())
+         - static_cast<long>(allocationStatistics().deallocations - m_deallocations);
+  }
+
+private:
+
+  std::size_t m_allocations, m_deallocations, m_bytes;
+
+};  // End of AllocationCounter class
+
+/**
+ * @brief    Number of heap allocations made by a call
+ * @param    <call> callable without arguments
+ * @return   number of calls to operator new
+ */
+template <typename Call>
+std::size_t countAllocations(Call call) {
+  AllocationCounter counter;
+  call();
+  return counter.getAllocations();
+}
+
+inline void* countedAllocation(std::size_t size) {
+  AllocationStatistics& statistics = allocationStatistics();
+  statistics.allocations.fetch_add(1, std::memory_order_relaxed);
+  statistics.bytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size == 0 ? 1 : size);
+}
+
+inline void* countedAlignedAllocation(std::size_t size, std::size_t alignment) {
+  AllocationStatistics& statistics = allocationStatistics();
+  statistics.allocations.fetch_add(1, std::memory_order_relaxed);
+  statistics.bytes.fetch_add(size, std::memory_order_relaxed);
+  void* pointer = nullptr;
+  if (posix_memalign(&pointer, std::max(alignment, sizeof(void*)), size == 0 ? 1 : size) != 0) {
+    return nullptr;
+  }
+  return pointer;
+}
+
+inline void countedDeallocation(void* pointer) {
+  if (pointer != nullptr) {
+    allocationStatistics().deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(pointer);
+  }
+}
+
+}  // namespace Testing
+}  // namespace DmModule
+
+void* operator new(std::size_t size) {
+  void* pointer = DmModule::Testing::countedAllocation(size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  return DmModule::Testing::countedAllocation(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return DmModule::Testing::countedAllocation(size);
+}
+
+void operator delete(void* pointer) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+// Over-aligned types, C++17
+#ifdef __cpp_aligned_new
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  void* pointer = DmModule::Testing::countedAlignedAllocation(size, static_cast<std::size_t>(alignment));
+  if (pointer == nullptr) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return DmModule::Testing::countedAlignedAllocation(size, static_cast<std::size_t>(alignment));
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+  return DmModule::Testing::countedAlignedAllocation(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept {
+  DmModule::Testing::countedDeallocation(pointer);
+}
+
+#endif
+
+#endif
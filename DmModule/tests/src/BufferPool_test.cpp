@@ -0,0 +1,71 @@
+/**
+ * @file tests/src/BufferPool_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <memory>
+#include <vector>
+
+#include "DmModule/BufferPool.h"
+
+using DmModule::BufferPool;
+
+namespace {
+
+std::unique_ptr<std::vector<double>> makeBuffer(std::size_t size) {
+  return std::unique_ptr<std::vector<double>>(new std::vector<double>(size));
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (BufferPool_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( reuse_test ) {
+
+  BufferPool<std::size_t, std::vector<double>> pool;
+  const std::vector<double>* first = nullptr;
+  {
+    auto buffer = pool.acquire(16, []() { return makeBuffer(16); });
+    BOOST_CHECK_EQUAL(buffer->size(), 16u);
+    first = buffer.get();
+  }
+  // the released buffer is leased again, a second concurrent lease allocates another one
+  auto again = pool.acquire(16, []() { return makeBuffer(16); });
+  BOOST_CHECK_EQUAL(again.get(), first);
+  auto second = pool.acquire(16, []() { return makeBuffer(16); });
+  BOOST_CHECK_NE(second.get(), first);
+  BOOST_CHECK_EQUAL(pool.getNbBuffers(), 2u);
+
+  // buffers are looked up by their key
+  auto other = pool.acquire(8, []() { return makeBuffer(8); });
+  BOOST_CHECK_EQUAL(other->size(), 8u);
+  BOOST_CHECK_EQUAL(pool.getNbBuffers(), 3u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
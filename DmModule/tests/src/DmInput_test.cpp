@@ -23,7 +23,24 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <utility>
+
 #include "DmModule//DmInput.h"
+#include "AllocationCounter.h"
+
+namespace fs = boost::filesystem;
+using DmModule::DmInput;
+using DmModule::Testing::countAllocations;
+
+namespace {
+
+// Allocation budgets of the DmInput API
+const std::size_t constructionFromTemporaryBudget = 0;   // the path is moved in
+const std::size_t constructionFromPathBudget = 1;        // one copy of the path
+const std::size_t moveBudget = 0;
+const std::size_t getterBudget = 0;
+
+}  // namespace
 
 //-----------------------------------------------------------------------------
 
@@ -31,14 +48,46 @@ BOOST_AUTO_TEST_SUITE (DmInput_test)
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_CASE( example_test ) {
+BOOST_AUTO_TEST_CASE( catalog_filename_test ) {
 
-  BOOST_FAIL("!!!! Please implement your tests !!!!");
+  DmInput input("EUC_LE3_WL_LensMCCatalog.fits");
+  BOOST_CHECK_EQUAL(input.getFitsCatalogFilename(), fs::path("EUC_LE3_WL_LensMCCatalog.fits"));
 
+  DmInput copy(input);
+  BOOST_CHECK_EQUAL(copy.getFitsCatalogFilename(), input.getFitsCatalogFilename());
+  copy = DmInput("other.fits");
+  BOOST_CHECK_EQUAL(copy.getFitsCatalogFilename(), fs::path("other.fits"));
 }
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_SUITE_END ()
+BOOST_AUTO_TEST_CASE( allocation_budget_test ) {
+
+  // long enough not to fit in the small string buffer
+  fs::path catalog("data/EUC_LE3_WL_LensMCCatalog_0123456789.fits");
 
+  std::size_t allocations = countAllocations([&]() { DmInput input(catalog); });
+  BOOST_CHECK_EQUAL(allocations, constructionFromPathBudget);
 
+  fs::path temporary(catalog);
+  allocations = countAllocations([&]() { DmInput input(std::move(temporary)); });
+  BOOST_CHECK_EQUAL(allocations, constructionFromTemporaryBudget);
+
+  DmInput input(catalog);
+  allocations = countAllocations([&]() {
+    DmInput moved(std::move(input));
+    DmInput assigned("");
+    assigned = std::move(moved);
+  });
+  BOOST_CHECK_EQUAL(allocations, moveBudget);
+
+  DmInput other(catalog);
+  const fs::path* filename = nullptr;
+  allocations = countAllocations([&]() { filename = &other.getFitsCatalogFilename(); });
+  BOOST_CHECK_EQUAL(allocations, getterBudget);
+  BOOST_CHECK_EQUAL(*filename, catalog);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
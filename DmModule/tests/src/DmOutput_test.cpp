@@ -21,9 +21,43 @@
  *
  */
 
+#include <memory>
+#include <string>
+
 #include <boost/test/unit_test.hpp>
 
+#include "ElementsKernel/Auxiliary.h"
+
 #include "DmModule//DmOutput.h"
+#include "DmModule/OutputPublisher.h"
+#include "AllocationCounter.h"
+
+namespace fs = boost::filesystem;
+using DmModule::Testing::AllocationCounter;
+using DmModule::Testing::countAllocations;
+
+namespace {
+
+// Allocation budgets of createOutputXml. The bindings and the logger allocate on their
+// own: the steady state of a call is measured on a short file name, the budgets bound
+// what a 4096 characters name and the following calls add to it
+const std::size_t nameAllocationBudget = 16;         // regrowth of the output and log buffers
+const std::size_t bytesPerNameCharacterBudget = 24;  // copies of the name, the output and the log line
+const long liveBudget = 0;                           // nothing left allocated
+
+// Schema of the output products, from the data model auxiliary files
+const std::string productNamespace = "http://euclid.esa.org/schema/dpd/le3/wl/twodmass/out/convergencepatch";
+const std::string productSchema =
+    "ST_DataModel/dpd/le3/wl/twodmass/out/euc-test-le3-wl-twodmass-ConvergencePatch.xsd";
+
+std::unique_ptr<dpd::le3::wl::twodmass::out::convergencepatch::dpdTwoDMassConvergencePatch>
+readProduct(const fs::path& filename, xml_schema::flags flags,
+            const xml_schema::properties& properties = xml_schema::properties()) {
+  return dpd::le3::wl::twodmass::out::convergencepatch::DpdTwoDMassConvergencePatch(filename.string(), flags,
+                                                                                     properties);
+}
+
+}  // namespace
 
 //-----------------------------------------------------------------------------
 
@@ -31,10 +65,87 @@ BOOST_AUTO_TEST_SUITE (DmOutput_test)
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_CASE( example_test ) {
+BOOST_AUTO_TEST_CASE( allocation_budget_test ) {
+
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("DmOutput_test_%%%%%%.xml");
+  std::string longName(4096, 'c');
+  auto write = [&filename](const std::string& name) { DmModule::DmOutput::createOutputXml(filename, name); };
+
+  // the first call sets up the bindings and the logger
+  write("Convergence.fits");
+  AllocationCounter shorter;
+  write("Convergence.fits");
+  std::size_t allocations = shorter.getAllocations();
+  std::size_t bytes = shorter.getBytes();
+  BOOST_CHECK_EQUAL(shorter.getLive(), liveBudget);
+
+  // the allocations do not grow with the file name, the memory grows linearly
+  AllocationCounter longer;
+  write(longName + ".fits");
+  BOOST_CHECK_LE(longer.getAllocations(), allocations + nameAllocationBudget);
+  BOOST_CHECK_LE(longer.getBytes(), bytes + bytesPerNameCharacterBudget * longName.size());
+  BOOST_CHECK_EQUAL(longer.getLive(), liveBudget);
+
+  // the following calls stay within the steady state
+  BOOST_CHECK_LE(countAllocations([&write]() { write("Convergence.fits"); }), allocations + 1);
+  fs::remove(filename);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( data_container_test ) {
+
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("DmOutput_test_%%%%%%.xml");
+  DmModule::DmOutput::createOutputXml(filename, "data/Convergence.fits.fz");
+
+  auto product = readProduct(filename, xml_schema::flags::dont_validate);
+  BOOST_CHECK_EQUAL(product->Header().ProductType(), "DpdTwoDMassConvergencePatch");
+  BOOST_REQUIRE(product->Data().NoisyConvergence().present());
+  BOOST_CHECK_EQUAL(product->Data().NoisyConvergence()->DataContainer().FileName(), "Convergence.fits.fz");
+  BOOST_CHECK_EQUAL(product->Data().NoisyConvergence()->DataContainer().filestatus(), "PROPOSED");
+  BOOST_CHECK_EQUAL(product->Data().NResamples(), 0);
+
+  // the noise statistics follow the convergence maps in the file
+  DmModule::DmOutput::createOutputXml(filename, "Convergence.fits", 16);
+  product = readProduct(filename, xml_schema::flags::dont_validate);
+  BOOST_CHECK_EQUAL(product->Data().NoisyConvergence()->DataContainer().FileName(), "Convergence.fits");
+  BOOST_CHECK_EQUAL(product->Data().NResamples(), 16);
+  BOOST_CHECK_EQUAL(product->Header().ExitStatusCode(), "OK");
+
+  // the product of maps which could not be made records the error
+  DmModule::DmOutput::createOutputXml(filename, "Convergence.fits", 0, "ERROR");
+  product = readProduct(filename, xml_schema::flags::dont_validate);
+  BOOST_CHECK_EQUAL(product->Header().ExitStatusCode(), "ERROR");
+  fs::remove(filename);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( schema_test ) {
+
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("DmOutput_test_%%%%%%.xml");
+  DmModule::DmOutput::createOutputXml(filename, "Convergence & Noise.fits.fz", 16);
+
+  // the parser throws on any element or attribute the schema does not define
+  xml_schema::properties properties;
+  properties.schema_location(productNamespace, "file://" + Elements::getAuxiliaryPath(productSchema).string());
+  auto product = readProduct(filename, 0, properties);
+  BOOST_CHECK_EQUAL(product->Data().NoisyConvergence()->DataContainer().FileName(), "Convergence & Noise.fits.fz");
+  fs::remove(filename);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( publisher_test ) {
 
-  BOOST_FAIL("!!!! Please implement your tests !!!!");
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("DmOutput_test_%%%%%%.xml");
+  DmModule::OutputPublisher publisher(1);
+  DmModule::DmOutput::createOutputXml(filename, "Convergence.fits", publisher);
+  publisher.flush();
 
+  auto product = readProduct(filename, xml_schema::flags::dont_validate);
+  BOOST_CHECK_EQUAL(product->Data().NoisyConvergence()->DataContainer().FileName(), "Convergence.fits");
+  fs::remove(filename);
 }
 
 //-----------------------------------------------------------------------------
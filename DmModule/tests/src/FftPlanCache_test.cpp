@@ -0,0 +1,98 @@
+/**
+ * @file tests/src/FftPlanCache_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <future>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/FftPlanCache.h"
+
+namespace fs = boost::filesystem;
+using DmModule::FftPlanCache;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (FftPlanCache_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( plans_test ) {
+
+  FftPlanCache& cache = FftPlanCache::getInstance();
+  BOOST_CHECK_EQUAL(&cache, &FftPlanCache::getInstance());
+  std::size_t size = cache.size();
+
+  // the threads asking for the same shape share one plan
+  std::vector<std::future<FftPlanCache::Plans>> plans;
+  for (int t = 0; t < 8; ++t) {
+    plans.push_back(std::async(std::launch::async, [&cache]() { return cache.getPlans(20, 10, 3); }));
+  }
+  FftPlanCache::Plans first = plans[0].get();
+  for (std::size_t t = 1; t < plans.size(); ++t) {
+    FftPlanCache::Plans other = plans[t].get();
+    BOOST_CHECK(other.forward == first.forward);
+    BOOST_CHECK(other.backward == first.backward);
+  }
+  BOOST_CHECK(first.forward != first.backward);
+  BOOST_CHECK_EQUAL(cache.size(), size + 1);
+
+  // an other batch size is an other plan
+  BOOST_CHECK(cache.getPlans(20, 10, 1).forward != first.forward);
+  BOOST_CHECK_EQUAL(cache.size(), size + 2);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( wisdom_test ) {
+
+  fs::path workdir = fs::temp_directory_path() / fs::unique_path("FftPlanCache_test_%%%%%%");
+  fs::create_directories(workdir);
+  FftPlanCache& cache = FftPlanCache::getInstance();
+
+  BOOST_CHECK(!cache.importWisdom(workdir / "missing.wisdom"));
+  cache.getPlans(8, 8);
+  cache.exportWisdom(workdir / "fft.wisdom");
+  BOOST_CHECK(fs::exists(workdir / "fft.wisdom"));
+  BOOST_CHECK_EQUAL(std::distance(fs::directory_iterator(workdir), fs::directory_iterator()), 1);
+  BOOST_CHECK(cache.importWisdom(workdir / "fft.wisdom"));
+  BOOST_CHECK_THROW(cache.exportWisdom(workdir / "missing" / "fft.wisdom"), Elements::Exception);
+
+  fs::remove_all(workdir);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( effort_test ) {
+
+  BOOST_CHECK(FftPlanCache::parseEffort("estimate") == FftPlanCache::Effort::ESTIMATE);
+  BOOST_CHECK(FftPlanCache::parseEffort("measure") == FftPlanCache::Effort::MEASURE);
+  BOOST_CHECK(FftPlanCache::parseEffort("patient") == FftPlanCache::Effort::PATIENT);
+  BOOST_CHECK_THROW(FftPlanCache::parseEffort("fast"), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,140 @@
+/**
+ * @file tests/src/KaiserSquires_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/KaiserSquires.h"
+
+using DmModule::KaiserSquires;
+using DmModule::PatchMap;
+
+namespace {
+
+// zero mean gaussian blob
+std::vector<double> makeConvergence(std::size_t xdim, std::size_t ydim) {
+  std::vector<double> kappa(xdim * ydim);
+  double mean = 0.;
+  for (std::size_t y = 0; y < ydim; ++y) {
+    for (std::size_t x = 0; x < xdim; ++x) {
+      double dx = x - xdim / 3., dy = y - ydim / 2.;
+      kappa[y * xdim + x] = 0.1 * std::exp(-(dx * dx + dy * dy) / 20.);
+      mean += kappa[y * xdim + x] / (xdim * ydim);
+    }
+  }
+  for (auto& value : kappa) {
+    value -= mean;
+  }
+  return kappa;
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (KaiserSquires_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( round_trip_test ) {
+
+  const std::size_t xdim = 32, ydim = 24;
+  std::vector<double> kappaE = makeConvergence(xdim, ydim), kappaB(xdim * ydim, 0.);
+  std::vector<double> gamma1(xdim * ydim), gamma2(xdim * ydim), outE(xdim * ydim), outB(xdim * ydim);
+
+  KaiserSquires ks(xdim, ydim);
+  ks.convergenceToShear(kappaE.data(), kappaB.data(), gamma1.data(), gamma2.data());
+  ks.shearToConvergence(gamma1.data(), gamma2.data(), outE.data(), outB.data());
+
+  for (std::size_t k = 0; k < xdim * ydim; ++k) {
+    BOOST_CHECK_SMALL(outE[k] - kappaE[k], 1e-12);
+    BOOST_CHECK_SMALL(outB[k], 1e-12);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( borders_test ) {
+
+  const std::size_t xdim = 32, ydim = 32;
+  PatchMap shear(xdim, ydim, 3);
+  std::vector<double> kappaE = makeConvergence(xdim, ydim), kappaB(xdim * ydim, 0.);
+  KaiserSquires(xdim, ydim).convergenceToShear(kappaE.data(), kappaB.data(), shear.getLayer(0), shear.getLayer(1));
+
+  KaiserSquires ks(xdim, ydim, true);
+  PatchMap kappa = ks.shearToConvergence(shear);
+  BOOST_CHECK_EQUAL(kappa.getNbLayers(), 2u);
+
+  // the padding changes the result but the blob is recovered at its place
+  std::size_t peak = 0;
+  for (std::size_t k = 0; k < xdim * ydim; ++k) {
+    if (kappa.getLayer(0)[k] > kappa.getLayer(0)[peak]) {
+      peak = k;
+    }
+  }
+  BOOST_CHECK_EQUAL(peak % xdim, 11u);
+  BOOST_CHECK_EQUAL(peak / xdim, 16u);
+
+  BOOST_CHECK_THROW(ks.shearToConvergence(PatchMap(16, 16, 3)), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( batch_test ) {
+
+  const std::size_t xdim = 16, ydim = 12, nbMaps = 5;
+  std::vector<PatchMap> shearMaps;
+  KaiserSquires single(xdim, ydim, true);
+  for (std::size_t m = 0; m < nbMaps; ++m) {
+    std::vector<double> kappaE = makeConvergence(xdim, ydim), kappaB(xdim * ydim, 0.);
+    for (auto& value : kappaE) {
+      value *= m + 1.;
+    }
+    shearMaps.emplace_back(xdim, ydim, 3, 0.01, m, 0.);
+    single.convergenceToShear(kappaE.data(), kappaB.data(), shearMaps[m].getLayer(0), shearMaps[m].getLayer(1));
+  }
+
+  // batches of 2, the last one partial, give the same maps as the transforms one by one
+  KaiserSquires batched(xdim, ydim, true, 2);
+  BOOST_CHECK_EQUAL(batched.getBatchSize(), 2u);
+  std::vector<PatchMap> kappa = batched.shearToConvergence(shearMaps);
+  BOOST_REQUIRE_EQUAL(kappa.size(), nbMaps);
+  for (std::size_t m = 0; m < nbMaps; ++m) {
+    PatchMap expected = single.shearToConvergence(shearMaps[m]);
+    BOOST_CHECK_EQUAL(kappa[m].getCenterX(), m);
+    for (std::size_t k = 0; k < xdim * ydim; ++k) {
+      BOOST_CHECK_SMALL(kappa[m].getLayer(0)[k] - expected.getLayer(0)[k], 1e-12);
+      BOOST_CHECK_SMALL(kappa[m].getLayer(1)[k] - expected.getLayer(1)[k], 1e-12);
+    }
+  }
+
+  shearMaps.emplace_back(xdim, xdim, 3);
+  BOOST_CHECK_THROW(batched.shearToConvergence(shearMaps), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
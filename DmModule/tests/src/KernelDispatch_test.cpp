@@ -0,0 +1,81 @@
+/**
+ * @file tests/src/KernelDispatch_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "DmModule/KernelDispatch.h"
+
+using namespace DmModule;
+
+namespace {
+
+struct FlagsKernel {
+  typedef int result_type;
+
+  template <bool First, bool Second, bool Third>
+  int run() const {
+    return (First ? 4 : 0) + (Second ? 2 : 0) + (Third ? 1 : 0) + offset;
+  }
+
+  int offset;
+};
+
+struct CountingKernel {
+  typedef void result_type;
+
+  template <bool Flag>
+  void run() const {
+    ++(Flag ? counts.second : counts.first);
+  }
+
+  std::pair<int, int>& counts;
+};
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (KernelDispatch_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( flags_order_test ) {
+  for (int flags = 0; flags < 8; ++flags) {
+    BOOST_CHECK_EQUAL(dispatchKernel(FlagsKernel{100}, flags & 4, flags & 2, flags & 1), 100 + flags);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( void_kernel_test ) {
+  std::pair<int, int> counts(0, 0);
+  dispatchKernel(CountingKernel{counts}, true);
+  dispatchKernel(CountingKernel{counts}, 0L);
+  dispatchKernel(CountingKernel{counts}, 2L);
+  BOOST_CHECK_EQUAL(counts.first, 1);
+  BOOST_CHECK_EQUAL(counts.second, 2);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,101 @@
+/**
+ * @file tests/src/MapMaker_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/MapMaker.h"
+
+using namespace DmModule;
+
+namespace {
+
+// one patch of 1 degree centered on (10, 20), pixels of 1 arcminute, two redshift bins [0, 1[ and [1, 2[
+Parameters makeParameters(long balancedBins, std::vector<double> zMin = {0., 1.}) {
+  return Parameters(0, 1, 1., 1., {10.}, {20.}, 2, zMin, 2., balancedBins, 0, 0, 0, 0, 0, 0., 0., 0);
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (MapMaker_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( binning_test ) {
+
+  Parameters param = makeParameters(0);
+  MapMaker mapMaker(param);
+  BOOST_CHECK_EQUAL(mapMaker.getNbPixels(), 60u);
+
+  ShearCatalog catalog({10., 10., 10., 25.}, {20., 20., 20., 20.}, {0.1, 0.3, 0.5, 0.1}, {-0.1, -0.1, 0.2, 0.},
+                       {1., 3., 1., 1.}, {0.5, 0.5, 1.5, 0.5});
+  std::vector<PatchMap> maps = mapMaker.makeShearMaps(catalog);
+  BOOST_REQUIRE_EQUAL(maps.size(), 2u);
+
+  // the first two galaxies fall in the central pixel of the first bin, the last one is outside the patch
+  BOOST_CHECK_EQUAL(maps[0](2, 30, 30), 2.);
+  BOOST_CHECK_CLOSE(maps[0](0, 30, 30), (0.1 + 3. * 0.3) / 4., 1e-9);
+  BOOST_CHECK_CLOSE(maps[0](1, 30, 30), -0.1, 1e-9);
+  BOOST_CHECK_EQUAL(maps[1](2, 30, 30), 1.);
+  BOOST_CHECK_CLOSE(maps[1](0, 30, 30), 0.5, 1e-9);
+
+  double total = 0.;
+  for (const auto& map : maps) {
+    for (std::size_t k = 0; k < map.getNbPixels(); ++k) {
+      total += map.getLayer(2)[k];
+    }
+  }
+  BOOST_CHECK_EQUAL(total, 3.);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( balanced_bins_test ) {
+
+  ShearCatalog catalog({10., 10., 10., 10.}, {20., 20., 20., 20.}, {0., 0., 0., 0.}, {0., 0., 0., 0.},
+                       {1., 1., 1., 1.}, {0.4, 0.1, 0.3, 0.2});
+
+  Parameters equalWidth = makeParameters(0, {0.});
+  std::vector<PatchMap> maps = MapMaker(equalWidth).makeShearMaps(catalog);
+  BOOST_CHECK_EQUAL(maps[0](2, 30, 30), 4.);
+  BOOST_CHECK_EQUAL(maps[1](2, 30, 30), 0.);
+
+  Parameters balanced = makeParameters(1, {0.});
+  maps = MapMaker(balanced).makeShearMaps(catalog);
+  BOOST_CHECK_EQUAL(maps[0](2, 30, 30), 2.);
+  BOOST_CHECK_EQUAL(maps[1](2, 30, 30), 2.);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( missing_center_test ) {
+
+  Parameters param(0, 2, 1., 1., {10.}, {20.}, 1, {0.}, 2., 0, 0, 0, 0, 0, 0, 0., 0., 0);
+  BOOST_CHECK_THROW(MapMaker mapMaker(param), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,239 @@
+/**
+ * @file tests/src/MassMapping_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/MassMapping.h"
+
+using namespace DmModule;
+
+namespace {
+
+Parameters makeParameters(int NItReducedShear, int NInpaint, float sigmaGauss, long ForceBMode = 0) {
+  return Parameters(NItReducedShear, 1, 1., 1., {0.}, {0.}, 1, {0.}, 2., 0, NInpaint, 0, ForceBMode, 3, 0, 0.,
+                    sigmaGauss, 0);
+}
+
+// shear of a zero mean gaussian blob, with one galaxy per pixel
+PatchMap makeShearMap(std::size_t size) {
+  std::vector<double> kappaE(size * size), kappaB(size * size, 0.);
+  double mean = 0.;
+  for (std::size_t y = 0; y < size; ++y) {
+    for (std::size_t x = 0; x < size; ++x) {
+      double dx = x - size / 2., dy = y - size / 2.;
+      kappaE[y * size + x] = 0.05 * std::exp(-(dx * dx + dy * dy) / 30.);
+      mean += kappaE[y * size + x] / (size * size);
+    }
+  }
+  for (auto& value : kappaE) {
+    value -= mean;
+  }
+  PatchMap shear(size, size, 3);
+  KaiserSquires(size, size).convergenceToShear(kappaE.data(), kappaB.data(), shear.getLayer(0), shear.getLayer(1));
+  std::fill(shear.getLayer(2), shear.getLayer(2) + size * size, 1.);
+  return shear;
+}
+
+// shear map with a band of empty pixels and shape noise elsewhere
+PatchMap makeNoisyShearMap(std::size_t size, unsigned seed) {
+  PatchMap shear = makeShearMap(size);
+  std::mt19937 generator(seed);
+  std::normal_distribution<double> noise(0., 0.001);
+  for (std::size_t y = 0; y < size; ++y) {
+    for (std::size_t x = 0; x < size; ++x) {
+      shear(0, x, y) += noise(generator);
+      shear(1, x, y) += noise(generator);
+      if (y >= 10 && y < 14) {
+        shear(0, x, y) = shear(1, x, y) = shear(2, x, y) = 0.;
+      }
+    }
+  }
+  return shear;
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (MassMapping_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( kaiser_squires_test ) {
+
+  const std::size_t size = 32;
+  PatchMap shear = makeShearMap(size);
+  PatchMap expected = KaiserSquires(size, size).shearToConvergence(shear);
+
+  // Without gaps, the inpainting always keeps the measured shear
+  for (int NInpaint : {0, 5}) {
+    Parameters param = makeParameters(0, NInpaint, 0.);
+    PatchMap kappa = MassMapping(param).reconstruct(shear);
+    for (std::size_t k = 0; k < size * size; ++k) {
+      BOOST_CHECK_SMALL(kappa.getLayer(0)[k] - expected.getLayer(0)[k], 1e-10);
+      BOOST_CHECK_SMALL(kappa.getLayer(1)[k], 1e-10);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( inpainting_test ) {
+
+  const std::size_t size = 32;
+  PatchMap shear = makeShearMap(size);
+  PatchMap expected = KaiserSquires(size, size).shearToConvergence(shear);
+
+  // empty a band of pixels
+  for (std::size_t y = 10; y < 14; ++y) {
+    for (std::size_t x = 0; x < size; ++x) {
+      shear(0, x, y) = shear(1, x, y) = shear(2, x, y) = 0.;
+    }
+  }
+
+  Parameters noInpaint = makeParameters(0, 0, 0.);
+  Parameters inpaint = makeParameters(0, 20, 0., 1);
+  PatchMap kappaKS = MassMapping(noInpaint).reconstruct(shear);
+  PatchMap kappaInpainted = MassMapping(inpaint).reconstruct(shear);
+
+  double errorKS = 0., errorInpainted = 0.;
+  for (std::size_t k = 0; k < size * size; ++k) {
+    errorKS += std::pow(kappaKS.getLayer(0)[k] - expected.getLayer(0)[k], 2);
+    errorInpainted += std::pow(kappaInpainted.getLayer(0)[k] - expected.getLayer(0)[k], 2);
+  }
+  BOOST_CHECK_LT(errorInpainted, errorKS);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( smoothing_test ) {
+
+  const std::size_t size = 32;
+  PatchMap shear = makeShearMap(size);
+  Parameters raw = makeParameters(2, 0, 0.);
+  Parameters smoothed = makeParameters(2, 0, 2.);
+  PatchMap kappaRaw = MassMapping(raw).reconstruct(shear);
+  PatchMap kappaSmoothed = MassMapping(smoothed).reconstruct(shear);
+
+  // smoothing lowers the peak but keeps the mean
+  double peakRaw = 0., peakSmoothed = 0., meanRaw = 0., meanSmoothed = 0.;
+  for (std::size_t k = 0; k < size * size; ++k) {
+    peakRaw = std::max(peakRaw, kappaRaw.getLayer(0)[k]);
+    peakSmoothed = std::max(peakSmoothed, kappaSmoothed.getLayer(0)[k]);
+    meanRaw += kappaRaw.getLayer(0)[k];
+    meanSmoothed += kappaSmoothed.getLayer(0)[k];
+  }
+  BOOST_CHECK_LT(peakSmoothed, peakRaw);
+  BOOST_CHECK_SMALL((meanSmoothed - meanRaw) / (size * size), 1e-4);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( batch_test ) {
+
+  // patches of two sizes, more than a batch of the first size
+  std::vector<PatchMap> shearMaps;
+  for (std::size_t p = 0; p < MassMapping::batchSize + 2; ++p) {
+    shearMaps.push_back(makeShearMap(16));
+    for (std::size_t x = 0; x < 16; ++x) {
+      shearMaps[p](0, x, p) = shearMaps[p](1, x, p) = shearMaps[p](2, x, p) = 0.;
+    }
+  }
+  shearMaps.push_back(makeShearMap(24));
+
+  Parameters param = makeParameters(1, 3, 1., 1);
+  MassMapping massMapping(param);
+  std::vector<PatchMap> kappa = massMapping.reconstruct(shearMaps);
+  BOOST_REQUIRE_EQUAL(kappa.size(), shearMaps.size());
+  for (std::size_t p = 0; p < shearMaps.size(); ++p) {
+    PatchMap expected = massMapping.reconstruct(shearMaps[p]);
+    BOOST_REQUIRE_EQUAL(kappa[p].getXdim(), expected.getXdim());
+    for (std::size_t k = 0; k < expected.getNbPixels(); ++k) {
+      BOOST_CHECK_SMALL(kappa[p].getLayer(0)[k] - expected.getLayer(0)[k], 1e-10);
+      BOOST_CHECK_SMALL(kappa[p].getLayer(1)[k] - expected.getLayer(1)[k], 1e-10);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( early_stop_test ) {
+
+  const std::size_t size = 32;
+  PatchMap expected = KaiserSquires(size, size).shearToConvergence(makeShearMap(size));
+  PatchMap shear = makeNoisyShearMap(size, 1);
+
+  Parameters full = makeParameters(2, 40, 0., 1);
+  Parameters stopped = makeParameters(2, 40, 0., 1);
+  stopped.setConvergenceTolerance(1e-3);
+  MassMapping::Iterations fullIterations, stoppedIterations;
+  PatchMap kappaFull = MassMapping(full).reconstruct(shear, &fullIterations);
+  PatchMap kappaStopped = MassMapping(stopped).reconstruct(shear, &stoppedIterations);
+  BOOST_CHECK_EQUAL(fullIterations.inpainting, 3 * 40);
+  BOOST_CHECK_EQUAL(fullIterations.reducedShear, 2);
+  BOOST_CHECK_LT(stoppedIterations.inpainting, fullIterations.inpainting / 2);
+
+  // stopping at the noise level does not make the map worse
+  double errorFull = 0., errorStopped = 0.;
+  for (std::size_t k = 0; k < size * size; ++k) {
+    errorFull += std::pow(kappaFull.getLayer(0)[k] - expected.getLayer(0)[k], 2);
+    errorStopped += std::pow(kappaStopped.getLayer(0)[k] - expected.getLayer(0)[k], 2);
+  }
+  BOOST_CHECK_LT(errorStopped, 1.1 * errorFull);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( warm_start_test ) {
+
+  // two redshift bins of the same patch, the second one starts from the first one
+  const std::size_t size = 32;
+  std::vector<PatchMap> shearMaps {makeNoisyShearMap(size, 2), makeNoisyShearMap(size, 3)};
+  Parameters param(0, 1, 1., 1., {0.}, {0.}, 2, {0., 1.}, 2., 0, 40, 0, 1, 3, 0, 0., 0., 0);
+  param.setConvergenceTolerance(1e-3);
+  std::vector<MassMapping::Iterations> iterations;
+  MassMapping(param).reconstruct(shearMaps, &iterations, 2);
+  BOOST_REQUIRE_EQUAL(iterations.size(), 2u);
+  BOOST_CHECK_LT(iterations[1].inpainting, iterations[0].inpainting);
+
+  // two patches of one redshift bin each are reconstructed independently
+  std::vector<MassMapping::Iterations> independent;
+  MassMapping(param).reconstruct(shearMaps, &independent);
+  MassMapping::Iterations alone;
+  MassMapping(param).reconstruct(shearMaps[1], &alone);
+  BOOST_REQUIRE_EQUAL(independent.size(), 2u);
+  BOOST_CHECK_EQUAL(independent[1].inpainting, alone.inpainting);
+
+  shearMaps.push_back(makeNoisyShearMap(size, 4));
+  BOOST_CHECK_THROW(MassMapping(param).reconstruct(shearMaps, nullptr, 2), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,171 @@
+/**
+ * @file tests/src/MemoryBudgetScheduler_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/MemoryBudgetScheduler.h"
+
+using namespace DmModule;
+
+namespace {
+
+Parameters makeParameters(int nbZBins, int nbSamples, float pixelSize) {
+  std::vector<double> zMin(nbZBins, 0.);
+  return Parameters(0, 1, pixelSize, 1., {10.}, {20.}, nbZBins, zMin, 2., 0, 0, 0, 1, 0, 0, 0.5, 1., nbSamples);
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (MemoryBudgetScheduler_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( estimate_test ) {
+
+  Parameters base = makeParameters(1, 1, 6.);
+  Parameters zbins = makeParameters(4, 1, 6.);
+  Parameters samples = makeParameters(1, 8, 6.);
+  Parameters fine = makeParameters(1, 1, 3.);
+
+  std::size_t reference = MemoryBudgetScheduler::estimatePeakMemory(base);
+  BOOST_CHECK_GT(reference, 10u * 10u * sizeof(double));
+  BOOST_CHECK_GT(MemoryBudgetScheduler::estimatePeakMemory(zbins), reference);
+  BOOST_CHECK_GT(MemoryBudgetScheduler::estimatePeakMemory(samples), reference);
+  // the noise realizations are reduced as they come, they are not all held
+  Parameters manySamples = makeParameters(1, 100000, 6.);
+  BOOST_CHECK_LT(MemoryBudgetScheduler::estimatePeakMemory(manySamples), 10000 * reference);
+  // two realizations in flight per worker
+  std::size_t oneWorker = MemoryBudgetScheduler::estimatePeakMemory(samples, 0, 1);
+  BOOST_CHECK_GT(oneWorker, reference);
+  BOOST_CHECK_GT(MemoryBudgetScheduler::estimatePeakMemory(samples, 0, 4), oneWorker);
+  BOOST_CHECK_EQUAL(MemoryBudgetScheduler::estimatePeakMemory(samples, 0, 4),
+                    MemoryBudgetScheduler::estimatePeakMemory(samples, 0, 16));
+  // four times the pixels
+  BOOST_CHECK_GT(MemoryBudgetScheduler::estimatePeakMemory(fine), 3 * reference);
+  // the catalog read by the job
+  BOOST_CHECK_GT(MemoryBudgetScheduler::estimatePeakMemory(base, 1000), reference + 1000 * 6 * sizeof(double));
+
+  Parameters invalid = makeParameters(1, 1, 0.);
+  BOOST_CHECK_THROW(MemoryBudgetScheduler::estimatePeakMemory(invalid), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( budget_test ) {
+
+  const std::size_t estimate = 64 * 1024 * 1024;
+  std::atomic<int> running(0);
+  std::promise<void> gate;
+  std::shared_future<void> open = gate.get_future().share();
+
+  MemoryBudgetScheduler scheduler(5 * estimate / 2, 8);
+  BOOST_CHECK_EQUAL(scheduler.getBudget(), 5 * estimate / 2);
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 6; ++i) {
+    results.push_back(scheduler.submit(estimate, [&running, open, i]() {
+      ++running;
+      open.wait();
+      return i;
+    }));
+  }
+  // two jobs fit in the budget before any memory is measured
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  BOOST_CHECK_EQUAL(running.load(), 2);
+  BOOST_CHECK_EQUAL(scheduler.getMaxConcurrency(), 2u);
+
+  gate.set_value();
+  for (int i = 0; i < 6; ++i) {
+    BOOST_CHECK_EQUAL(results[i].get(), i);
+  }
+  BOOST_CHECK_EQUAL(running.load(), 6);
+  // the jobs use almost no memory, the correction lowers the next estimates
+  BOOST_CHECK_LE(scheduler.getCorrection(), 1.);
+  BOOST_CHECK_GE(scheduler.getCorrection(), 0.25);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( oversized_job_test ) {
+
+  MemoryBudgetScheduler scheduler(1024, 2);
+  auto small = scheduler.submit(512, []() { return 1; });
+  auto large = scheduler.submit(1 << 20, []() { return 2; });
+  auto failing = scheduler.submit(512, []() -> int { throw std::runtime_error("job failed"); });
+  BOOST_CHECK_EQUAL(small.get(), 1);
+  BOOST_CHECK_EQUAL(large.get(), 2);
+  BOOST_CHECK_THROW(failing.get(), std::runtime_error);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( correction_test ) {
+
+  const std::size_t estimate = 4 * 1024 * 1024;
+  MemoryBudgetScheduler scheduler(64 * estimate, 1);
+  BOOST_CHECK_EQUAL(scheduler.getCorrection(), 1.);
+  // each job touches four times its estimate
+  for (int i = 0; i < 3; ++i) {
+    scheduler.submit(estimate, [estimate]() {
+      std::vector<char> buffer(4 * estimate, 1);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      return buffer[estimate];
+    }).get();
+  }
+  BOOST_CHECK_GT(scheduler.getCorrection(), 1.);
+  BOOST_CHECK_LE(scheduler.getCorrection(), 4.);
+  BOOST_CHECK_GT(MemoryBudgetScheduler::getResidentMemory(), 0u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( start_memory_test ) {
+
+  const std::size_t estimate = 4 * 1024 * 1024;
+  MemoryBudgetScheduler scheduler(64 * estimate, 1);
+  // memory taken after the scheduler was made, outside of the jobs
+  std::vector<char> held(16 * estimate, 1);
+  // each job touches half of its estimate
+  for (int i = 0; i < 3; ++i) {
+    scheduler.submit(estimate, [estimate]() {
+      std::vector<char> buffer(estimate / 2, 1);
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      return buffer[estimate / 4];
+    }).get();
+  }
+  // only the memory taken since each job started is counted
+  BOOST_CHECK_LE(scheduler.getCorrection(), 1.);
+  BOOST_CHECK_EQUAL(held[estimate], 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
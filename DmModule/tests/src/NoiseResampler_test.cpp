@@ -0,0 +1,155 @@
+/**
+ * @file tests/src/NoiseResampler_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "DmModule/NoiseResampler.h"
+
+using namespace DmModule;
+
+namespace {
+
+// one patch of 1 degree centered on (10, 20) with pixels of 6 arcminutes, two redshift bins
+Parameters makeParameters(int nbSamples) {
+  return Parameters(0, 1, 6., 1., {10.}, {20.}, 2, {0., 1.}, 2., 0, 0, 0, 1, 0, 0, 0., 0., nbSamples);
+}
+
+ShearCatalog makeCatalog(std::size_t nbGalaxies) {
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> ra(9.5, 10.5), dec(19.5, 20.5), z(0., 2.), weight(0.5, 1.5);
+  std::normal_distribution<double> shear(0., 0.3);
+  std::vector<double> columns[6];
+  for (std::size_t i = 0; i < nbGalaxies; ++i) {
+    columns[0].push_back(ra(generator));
+    columns[1].push_back(dec(generator));
+    columns[2].push_back(shear(generator));
+    columns[3].push_back(shear(generator));
+    columns[4].push_back(weight(generator));
+    columns[5].push_back(z(generator));
+  }
+  return ShearCatalog(columns[0], columns[1], columns[2], columns[3], columns[4], columns[5]);
+}
+
+bool sameMaps(const std::vector<PatchMap>& a, const std::vector<PatchMap>& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (std::size_t m = 0; m < a.size(); ++m) {
+    std::size_t size = a[m].getNbPixels() * a[m].getNbLayers();
+    if (!std::equal(a[m].getLayer(0), a[m].getLayer(0) + size, b[m].getLayer(0))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (NoiseResampler_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( realization_test ) {
+
+  Parameters param = makeParameters(4);
+  ShearCatalog catalog = makeCatalog(2000);
+  NoiseResampler resampler(param, catalog, 42);
+
+  std::vector<PatchMap> first = resampler.makeRealization(3);
+  BOOST_REQUIRE_EQUAL(first.size(), 2u);
+  BOOST_CHECK_EQUAL(first[0].getNbLayers(), 2u);
+  // a realization only depends on the seed and on its index
+  BOOST_CHECK(sameMaps(resampler.makeRealization(3), first));
+  BOOST_CHECK(!sameMaps(resampler.makeRealization(4), first));
+  BOOST_CHECK(!sameMaps(NoiseResampler(param, catalog, 43).makeRealization(3), first));
+  // the shear map buffer is reused
+  BOOST_CHECK_EQUAL(resampler.getNbBuffers(), 1u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( statistics_test ) {
+
+  Parameters param = makeParameters(6);
+  ShearCatalog catalog = makeCatalog(2000);
+  NoiseResampler resampler(param, catalog, 1);
+
+  WorkerPool pool(3);
+  NoiseResampler::Statistics statistics = resampler.resample(pool);
+  BOOST_CHECK_EQUAL(statistics.nbRealizations, 6);
+  BOOST_REQUIRE_EQUAL(statistics.mean.size(), 2u);
+  BOOST_REQUIRE_EQUAL(statistics.variance.size(), 2u);
+  // at most two realizations per worker in flight
+  BOOST_CHECK_LE(resampler.getNbBuffers(), 6u);
+
+  // mean and variance of the realizations made one by one
+  std::vector<std::vector<PatchMap>> realizations;
+  for (int r = 0; r < 6; ++r) {
+    realizations.push_back(resampler.makeRealization(r));
+  }
+  for (std::size_t m = 0; m < 2; ++m) {
+    std::size_t size = realizations[0][m].getNbPixels() * 2;
+    for (std::size_t k = 0; k < size; ++k) {
+      double sum = 0., squares = 0.;
+      for (const auto& realization : realizations) {
+        sum += realization[m].getLayer(0)[k];
+      }
+      double mean = sum / 6.;
+      for (const auto& realization : realizations) {
+        squares += std::pow(realization[m].getLayer(0)[k] - mean, 2);
+      }
+      BOOST_CHECK_SMALL(statistics.mean[m].getLayer(0)[k] - mean, 1e-12);
+      BOOST_CHECK_SMALL(statistics.variance[m].getLayer(0)[k] - squares / 5., 1e-12);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( thread_count_test ) {
+
+  Parameters param = makeParameters(8);
+  ShearCatalog catalog = makeCatalog(1000);
+  NoiseResampler resampler(param, catalog, 5);
+
+  WorkerPool single(1), several(4);
+  NoiseResampler::Statistics one = resampler.resample(single);
+  NoiseResampler::Statistics four = resampler.resample(several);
+  // the same bits whatever the number of threads
+  BOOST_CHECK(sameMaps(one.mean, four.mean));
+  BOOST_CHECK(sameMaps(one.variance, four.variance));
+
+  NoiseResampler::Statistics none = resampler.resample(0, several);
+  BOOST_CHECK_EQUAL(none.nbRealizations, 0);
+  BOOST_CHECK(none.mean.empty());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,148 @@
+/**
+ * @file tests/src/OutputCompressor_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+#include <fitsio.h>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/OutputCompressor.h"
+
+namespace fs = boost::filesystem;
+using DmModule::OutputCompressor;
+using DmModule::PatchMap;
+
+namespace {
+
+// Pixels of an image extension and its LOSSY keyword, the extension is decompressed on reading
+std::vector<double> readPixels(const fs::path& filename, int hdu, long nbPixels, bool& lossy) {
+  fitsfile* fptr = nullptr;
+  int status = 0, anynul = 0, flag = 0;
+  std::vector<double> pixels(nbPixels);
+  fits_open_file(&fptr, filename.string().c_str(), READONLY, &status);
+  fits_movabs_hdu(fptr, hdu, nullptr, &status);
+  fits_read_img(fptr, TDOUBLE, 1, nbPixels, nullptr, pixels.data(), &anynul, &status);
+  fits_read_key(fptr, TLOGICAL, "LOSSY", &flag, nullptr, &status);
+  int close_status = 0;
+  if (fptr != nullptr) {
+    fits_close_file(fptr, &close_status);
+  }
+  BOOST_REQUIRE_EQUAL(status, 0);
+  lossy = flag != 0;
+  return pixels;
+}
+
+// Maps of white noise in [-1, 1)
+std::vector<PatchMap> makeMaps() {
+  std::mt19937 generator(29);
+  std::uniform_real_distribution<double> noise(-1., 1.);
+  std::vector<PatchMap> maps(3, PatchMap(16, 16, 2, 0.01));
+  for (auto& map : maps) {
+    for (std::size_t p = 0; p < map.getNbPixels() * map.getNbLayers(); ++p) {
+      map.getLayer(0)[p] = noise(generator);
+    }
+  }
+  return maps;
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (OutputCompressor_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( format_test ) {
+  BOOST_CHECK(OutputCompressor::parseFormat("none") == OutputCompressor::Format::NONE);
+  BOOST_CHECK(OutputCompressor::parseFormat("RICE") == OutputCompressor::Format::RICE);
+  BOOST_CHECK(OutputCompressor::parseFormat(" gzip") == OutputCompressor::Format::GZIP);
+  BOOST_CHECK_THROW(OutputCompressor::parseFormat("zip"), Elements::Exception);
+
+  BOOST_CHECK_EQUAL(OutputCompressor(OutputCompressor::Format::NONE).getMapFormat(), "NONE");
+  BOOST_CHECK_EQUAL(OutputCompressor(OutputCompressor::Format::RICE, 1).getMapFormat(), "RICE_1");
+  BOOST_CHECK_EQUAL(OutputCompressor(OutputCompressor::Format::GZIP, 1).getMapFormat(), "GZIP_2");
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( write_maps_test ) {
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("OutputCompressor_test_%%%%%%.fits");
+  std::vector<PatchMap> maps(3, PatchMap(16, 16, 2, 0.01));
+  maps[2](1, 3, 5) = 1.;
+
+  OutputCompressor compressor(OutputCompressor::Format::RICE, 3);
+  fs::path compressed = compressor.writeMaps(filename, maps);
+  BOOST_CHECK_EQUAL(compressed, fs::path(filename.string() + ".fz"));
+  BOOST_CHECK(fs::exists(compressed));
+  BOOST_CHECK(!fs::exists(filename));
+
+  // Compression of an existing file
+  PatchMap::writeFits(filename, maps);
+  OutputCompressor gzip(OutputCompressor::Format::GZIP, 3);
+  BOOST_CHECK_EQUAL(gzip.compressFits(filename), compressed);
+  BOOST_CHECK(fs::exists(compressed));
+  BOOST_CHECK(!fs::exists(filename));
+  fs::remove(compressed);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( round_trip_test ) {
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("OutputCompressor_test_%%%%%%.fits");
+  std::vector<PatchMap> maps = makeMaps();
+  long nbPixels = static_cast<long>(maps[0].getNbPixels() * maps[0].getNbLayers());
+
+  // GZIP_2 gives the pixel values back exactly
+  OutputCompressor gzip(OutputCompressor::Format::GZIP, 3);
+  fs::path compressed = gzip.writeMaps(filename, maps);
+  for (std::size_t m = 0; m < maps.size(); ++m) {
+    bool lossy = true;
+    std::vector<double> pixels = readPixels(compressed, static_cast<int>(m) + 2, nbPixels, lossy);
+    BOOST_CHECK(!lossy);
+    BOOST_CHECK_EQUAL_COLLECTIONS(pixels.begin(), pixels.end(), maps[m].getLayer(0), maps[m].getLayer(0) + nbPixels);
+  }
+  fs::remove(compressed);
+
+  // RICE_1 quantizes the values with a step of a quarter of the noise level (about
+  // 0.6 for this white noise), they come back within half a step
+  OutputCompressor rice(OutputCompressor::Format::RICE, 3);
+  compressed = rice.writeMaps(filename, maps);
+  for (std::size_t m = 0; m < maps.size(); ++m) {
+    bool lossy = false;
+    std::vector<double> pixels = readPixels(compressed, static_cast<int>(m) + 2, nbPixels, lossy);
+    BOOST_CHECK(lossy);
+    for (long p = 0; p < nbPixels; ++p) {
+      BOOST_CHECK_SMALL(pixels[p] - maps[m].getLayer(0)[p], 0.25);
+    }
+  }
+  fs::remove(compressed);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,122 @@
+/**
+ * @file tests/src/OutputPublisher_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/OutputPublisher.h"
+
+namespace fs = boost::filesystem;
+using DmModule::OutputPublisher;
+
+namespace {
+
+std::string readFile(const fs::path& filename) {
+  std::ifstream in(filename.string());
+  return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+std::size_t countFiles(const fs::path& directory) {
+  return static_cast<std::size_t>(std::distance(fs::directory_iterator(directory), fs::directory_iterator()));
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (OutputPublisher_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( group_commit_test ) {
+
+  fs::path workdir = fs::temp_directory_path() / fs::unique_path("OutputPublisher_test_%%%%%%");
+  fs::create_directories(workdir);
+  {
+    OutputPublisher publisher(4, std::chrono::milliseconds(10000), 16);
+    for (int i = 0; i < 40; ++i) {
+      publisher.publish(workdir / ("out_" + std::to_string(i) + ".xml"), "product " + std::to_string(i));
+    }
+    publisher.flush();
+
+    // 40 outputs need at least 3 groups of 16, far less than one commit per output
+    BOOST_CHECK_GE(publisher.getNbGroupCommits(), 3u);
+    BOOST_CHECK_LT(publisher.getNbGroupCommits(), 40u);
+  }
+
+  BOOST_CHECK_EQUAL(countFiles(workdir), 40u);
+  for (int i = 0; i < 40; ++i) {
+    BOOST_CHECK_EQUAL(readFile(workdir / ("out_" + std::to_string(i) + ".xml")), "product " + std::to_string(i));
+  }
+  fs::remove_all(workdir);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( latency_test ) {
+
+  fs::path workdir = fs::temp_directory_path() / fs::unique_path("OutputPublisher_test_%%%%%%");
+  fs::create_directories(workdir);
+
+  OutputPublisher publisher(2, std::chrono::milliseconds(20), 64);
+  std::future<void> done = publisher.publish(workdir / "single.xml", "content");
+  // Published without flush once the latency target is reached
+  BOOST_REQUIRE(done.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  done.get();
+  BOOST_CHECK_EQUAL(readFile(workdir / "single.xml"), "content");
+  BOOST_CHECK_EQUAL(countFiles(workdir), 1u);
+
+  // Files written by the caller to a staging file
+  fs::path staged = OutputPublisher::getStagingPath(workdir / "map.fits");
+  BOOST_CHECK_EQUAL(staged.parent_path(), workdir);
+  std::ofstream(staged.string()) << "map";
+  BOOST_CHECK(!fs::exists(workdir / "map.fits"));
+  publisher.publishFile(staged, workdir / "map.fits");
+  publisher.flush();
+  BOOST_CHECK_EQUAL(readFile(workdir / "map.fits"), "map");
+  BOOST_CHECK(!fs::exists(staged));
+
+  fs::remove_all(workdir);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( error_test ) {
+
+  fs::path missing = fs::temp_directory_path() / fs::unique_path("OutputPublisher_missing_%%%%%%") / "out.xml";
+  OutputPublisher publisher(1, std::chrono::milliseconds(10), 8);
+  std::future<void> done = publisher.publish(missing, "content");
+  BOOST_CHECK_THROW(publisher.flush(), Elements::Exception);
+  BOOST_CHECK_THROW(done.get(), Elements::Exception);
+  // The errors are reported once
+  BOOST_CHECK_NO_THROW(publisher.flush());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
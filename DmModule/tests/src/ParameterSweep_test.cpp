@@ -0,0 +1,151 @@
+/**
+ * @file tests/src/ParameterSweep_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/MemoryBudgetScheduler.h"
+#include "DmModule/ParameterSweep.h"
+
+namespace fs = boost::filesystem;
+using namespace DmModule;
+
+namespace {
+
+Parameters makeBase() {
+  return Parameters(0, 1, 6., 1., {10.}, {20.}, 1, {0.}, 2., 0, 0, 0, 1, 0, 0, 0.5, 1., 0);
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (ParameterSweep_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( grid_test ) {
+
+  Parameters base = makeBase();
+  ParameterSweep sweep(base, "sigmaGauss=1,2; NInpaint=0,10,20");
+  BOOST_REQUIRE_EQUAL(sweep.getNbPoints(), 6u);
+
+  BOOST_CHECK_EQUAL(sweep.getLabel(0), "sigmaGauss=1 NInpaint=0");
+  BOOST_CHECK_EQUAL(sweep.getLabel(5), "sigmaGauss=2 NInpaint=20");
+  BOOST_CHECK_EQUAL(sweep.getPoint(1).getNInpaint(), 10);
+  BOOST_CHECK_EQUAL(sweep.getPoint(4).getSigmaGauss(), 2.f);
+
+  // the other parameters are taken from the base
+  Parameters& point = sweep.getPoint(3);
+  BOOST_CHECK_CLOSE(point.getPixelsize(), base.getPixelsize(), 1e-4);
+  BOOST_CHECK_EQUAL(point.getPatchWidth(), base.getPatchWidth());
+  BOOST_CHECK_EQUAL(point.getRSSigmaGauss(), 0.5f);
+  BOOST_CHECK_EQUAL(point.getForceBMode(), 1);
+  BOOST_CHECK_EQUAL(point.getMapCenterX().size(), 1u);
+
+  // the sweep makes no noise realizations, they are not in the estimates of its points
+  Parameters noisy(0, 1, 6., 1., {10.}, {20.}, 1, {0.}, 2., 0, 0, 0, 1, 0, 0, 0.5, 1., 16);
+  ParameterSweep noisySweep(noisy, "sigmaGauss=1");
+  BOOST_CHECK_EQUAL(noisySweep.getPoint(0).getNSamples(), 0);
+  BOOST_CHECK_EQUAL(MemoryBudgetScheduler::estimatePeakMemory(noisySweep.getPoint(0), 0, 2),
+                    MemoryBudgetScheduler::estimatePeakMemory(base, 0, 2));
+  BOOST_CHECK_LT(MemoryBudgetScheduler::estimatePeakMemory(noisySweep.getPoint(0), 0, 2),
+                 MemoryBudgetScheduler::estimatePeakMemory(noisy, 0, 2));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( invalid_grid_test ) {
+
+  Parameters base = makeBase();
+  BOOST_CHECK_THROW(ParameterSweep(base, ""), Elements::Exception);
+  BOOST_CHECK_THROW(ParameterSweep(base, "nbPatches=1,2"), Elements::Exception);
+  BOOST_CHECK_THROW(ParameterSweep(base, "sigmaGauss=1,a"), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( run_test ) {
+
+  fs::path workdir = fs::temp_directory_path() / fs::unique_path("ParameterSweep_test_%%%%%%");
+  fs::create_directories(workdir / "data");
+
+  ShearCatalog catalog({10., 10.1, 9.9, 10.2}, {20., 20.1, 19.9, 19.8}, {0.01, 0.02, -0.01, 0.},
+                       {0., 0.01, 0.02, -0.02}, {1., 1., 1., 1.}, {0.5, 0.6, 0.7, 0.8});
+  Parameters base = makeBase();
+  ParameterSweep sweep(base, "sigmaGauss=0,1;thresholdFDR=0.05");
+  std::vector<fs::path> products = sweep.run(catalog, workdir, "Sweep.xml", 2);
+
+  BOOST_REQUIRE_EQUAL(products.size(), 2u);
+  BOOST_CHECK_EQUAL(products[1], workdir / "Sweep_0001.xml");
+  BOOST_CHECK(fs::exists(workdir / "data" / "Sweep_0000.fits"));
+  BOOST_CHECK(fs::exists(workdir / "data" / "Sweep_0001.fits"));
+
+  // Compressed maps are recorded with their name in the products
+  products = sweep.run(catalog, workdir, "Packed.xml", 2, OutputCompressor::Format::GZIP);
+  BOOST_CHECK(fs::exists(workdir / "data" / "Packed_0001.fits.fz"));
+  std::ifstream in(products[1].string());
+  std::string product((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  BOOST_CHECK(product.find("<FileName>Packed_0001.fits.fz</FileName>") != std::string::npos);
+  // no staging file left behind
+  BOOST_CHECK_EQUAL(std::distance(fs::directory_iterator(workdir / "data"), fs::directory_iterator()), 4);
+
+  // Grid points placed on the NUMA nodes
+  products = sweep.run(catalog, workdir, "Placed.xml", 2, OutputCompressor::Format::NONE, 0,
+                       WorkerPool::Placement::SOCKET);
+  BOOST_CHECK_EQUAL(products[0], workdir / "Placed_0000.xml");
+  BOOST_CHECK(fs::exists(workdir / "data" / "Placed_0001.fits"));
+
+  fs::remove_all(workdir);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( failing_point_test ) {
+
+  fs::path workdir = fs::temp_directory_path() / fs::unique_path("ParameterSweep_test_%%%%%%");
+  fs::create_directories(workdir / "data");
+
+  ShearCatalog catalog({10., 10.1, 9.9, 10.2}, {20., 20.1, 19.9, 19.8}, {0.01, 0.02, -0.01, 0.},
+                       {0., 0.01, 0.02, -0.02}, {1., 1., 1., 1.}, {0.5, 0.6, 0.7, 0.8});
+  Parameters base = makeBase();
+  // the smoothing kernel of the second point is too large to be allocated
+  ParameterSweep sweep(base, "sigmaGauss=1,1e18,2");
+  BOOST_CHECK_THROW(sweep.run(catalog, workdir, "Failing.xml", 2), std::length_error);
+
+  // the error is reported once the other points are done
+  BOOST_CHECK(fs::exists(workdir / "data" / "Failing_0000.fits"));
+  BOOST_CHECK(fs::exists(workdir / "data" / "Failing_0002.fits"));
+  BOOST_CHECK(!fs::exists(workdir / "data" / "Failing_0001.fits"));
+
+  fs::remove_all(workdir);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -23,7 +23,32 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <utility>
+#include <vector>
+
 #include "DmModule//Parameters.h"
+#include "AllocationCounter.h"
+
+using DmModule::Parameters;
+using DmModule::Testing::AllocationCounter;
+using DmModule::Testing::countAllocations;
+
+namespace {
+
+// Allocation budgets of the Parameters API
+const std::size_t constructionFromTemporariesBudget = 0;   // the vectors are moved in
+const std::size_t constructionFromVectorsBudget = 3;       // one copy of each vector
+const std::size_t copyBudget = 3;
+const std::size_t moveBudget = 0;
+const std::size_t getterBudget = 0;
+
+Parameters makeParameters(std::size_t nbPatches) {
+  return Parameters(2, static_cast<int>(nbPatches), 6., 1.5, std::vector<double>(nbPatches, 10.),
+                    std::vector<double>(nbPatches, 20.), 3, std::vector<double>(3, 0.5), 2., 1, 100, 1, 0, 5, 1,
+                    0.5, 1., 4, 0.1, 0.05);
+}
+
+}  // namespace
 
 //-----------------------------------------------------------------------------
 
@@ -31,14 +56,93 @@ BOOST_AUTO_TEST_SUITE (Parameters_test)
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_CASE( example_test ) {
+BOOST_AUTO_TEST_CASE( constructor_test ) {
 
-  BOOST_FAIL("!!!! Please implement your tests !!!!");
+  Parameters param = makeParameters(2);
+  BOOST_CHECK_EQUAL(param.getNItReducedShear(), 2);
+  BOOST_CHECK_EQUAL(param.getnbPatches(), 2);
+  // the pixel size is given in arcminutes and stored in degrees
+  BOOST_CHECK_CLOSE(param.getPixelsize(), 0.1f, 1e-4);
+  BOOST_CHECK_EQUAL(param.getPatchWidth(), 1.5f);
+  BOOST_CHECK_EQUAL(param.getMapCenterX().size(), 2u);
+  BOOST_CHECK_EQUAL(param.getMapCenterY()[1], 20.);
+  BOOST_CHECK_EQUAL(param.getnbZBins(), 3);
+  BOOST_CHECK_EQUAL(param.getZMin().size(), 3u);
+  BOOST_CHECK_EQUAL(param.getZMax(), 2.);
+  BOOST_CHECK_EQUAL(param.get_BalancedBins(), 1);
+  BOOST_CHECK_EQUAL(param.getNInpaint(), 100);
+  BOOST_CHECK_EQUAL(param.getEqualVarPerScale(), 1);
+  BOOST_CHECK_EQUAL(param.getForceBMode(), 0);
+  BOOST_CHECK_EQUAL(param.getnbScales(), 5);
+  BOOST_CHECK_EQUAL(param.get_addBorders(), 1);
+  BOOST_CHECK_EQUAL(param.getRSSigmaGauss(), 0.5f);
+  BOOST_CHECK_EQUAL(param.getSigmaGauss(), 1.f);
+  BOOST_CHECK_EQUAL(param.getNSamples(), 4);
+  BOOST_CHECK_EQUAL(param.getRSThreshold(), 0.1f);
+  BOOST_CHECK_EQUAL(param.getThreshold(), 0.05f);
 
+  Parameters defaults;
+  BOOST_CHECK_EQUAL(defaults.getnbPatches(), 1);
+  BOOST_CHECK_EQUAL(defaults.getNInpaint(), 100);
+  BOOST_CHECK_EQUAL(defaults.getForceBMode(), 1);
 }
 
 //-----------------------------------------------------------------------------
 
-BOOST_AUTO_TEST_SUITE_END ()
+BOOST_AUTO_TEST_CASE( allocation_budget_test ) {
+
+  std::vector<double> centerX(8, 10.), centerY(8, 20.), zMin(3, 0.5);
+
+  std::size_t allocations = countAllocations([&]() {
+    Parameters param(0, 8, 6., 1., centerX, centerY, 3, zMin, 2., 0, 0, 0, 1, 0, 0, 0.5, 1., 0);
+  });
+  BOOST_CHECK_EQUAL(allocations, constructionFromVectorsBudget);
+
+  allocations = countAllocations([&]() {
+    Parameters param(0, 8, 6., 1., std::move(centerX), std::move(centerY), 3, std::move(zMin), 2., 0, 0, 0, 1, 0,
+                     0, 0.5, 1., 0);
+  });
+  BOOST_CHECK_EQUAL(allocations, constructionFromTemporariesBudget);
 
+  Parameters param = makeParameters(8);
+  allocations = countAllocations([&]() { Parameters copy(param); });
+  BOOST_CHECK_EQUAL(allocations, copyBudget);
+  Parameters copy(param);
+  allocations = countAllocations([&]() {
+    Parameters moved(std::move(copy));
+    Parameters assigned;
+    assigned = std::move(moved);
+  });
+  BOOST_CHECK_EQUAL(allocations, moveBudget);
+  std::size_t size = 0;
+  allocations = countAllocations([&]() {
+    size = param.getMapCenterX().size() + param.getMapCenterY().size() + param.getZMin().size();
+  });
+  BOOST_CHECK_EQUAL(allocations, getterBudget);
+  BOOST_CHECK_EQUAL(size, 19u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( read_parameter_file_budget_test ) {
+
+  // The vectors are copied once in the returned Parameters: the memory allocated
+  // by readParameterFile grows with one copy of them, whatever it logs
+  const std::size_t nbPatches = 1000;
+  Parameters thin = makeParameters(1);
+  Parameters fat = makeParameters(nbPatches);
+
+  AllocationCounter thinCounter;
+  Parameters fromThin = thin.readParameterFile("Parameters.xml");
+  std::size_t thinBytes = thinCounter.getBytes();
+  AllocationCounter fatCounter;
+  Parameters fromFat = fat.readParameterFile("Parameters.xml");
+  std::size_t fatBytes = fatCounter.getBytes();
 
+  BOOST_CHECK_EQUAL(fromFat.getMapCenterX().size(), nbPatches);
+  BOOST_CHECK_LE(fatBytes - thinBytes, 2 * (nbPatches - 1) * sizeof(double));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,67 @@
+/**
+ * @file tests/src/PatchMap_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include "DmModule/PatchMap.h"
+
+namespace fs = boost::filesystem;
+using DmModule::PatchMap;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (PatchMap_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( layout_test ) {
+
+  PatchMap map(4, 3, 2, 0.01, 10., 20.);
+  BOOST_CHECK_EQUAL(map.getNbPixels(), 12u);
+  BOOST_CHECK_EQUAL(map.getNbLayers(), 2u);
+  for (std::size_t k = 0; k < 24; ++k) {
+    BOOST_CHECK_EQUAL(map.getLayer(0)[k], 0.);
+  }
+
+  map(1, 3, 2) = 5.;
+  BOOST_CHECK_EQUAL(map.getLayer(1)[2 * 4 + 3], 5.);
+  BOOST_CHECK_EQUAL(map.getCenterX(), 10.);
+  BOOST_CHECK_EQUAL(map.getCenterY(), 20.);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( write_fits_test ) {
+
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("PatchMap_test_%%%%%%.fits");
+  std::vector<PatchMap> maps(2, PatchMap(8, 8, 2, 0.01));
+  maps[1](0, 4, 4) = 1.;
+
+  PatchMap::writeFits(filename, maps);
+  BOOST_CHECK(fs::exists(filename));
+  fs::remove(filename);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
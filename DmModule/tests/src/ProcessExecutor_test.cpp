@@ -0,0 +1,150 @@
+/**
+ * @file tests/src/ProcessExecutor_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <chrono>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/types.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+
+#include "DmModule/ProcessExecutor.h"
+
+using DmModule::ProcessExecutor;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (ProcessExecutor_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( output_test ) {
+
+  ProcessExecutor executor(2);
+
+  // The arguments are not interpreted by a shell
+  auto echo = executor.submit({"echo", "a b;c", "$HOME"});
+  auto script = executor.submit({"sh", "-c", "echo out; echo err >&2; exit 3"});
+  auto large = executor.submit({"head", "-c", "1000000", "/dev/zero"});
+
+  ProcessExecutor::Result result = echo.get();
+  BOOST_CHECK(result.succeeded());
+  BOOST_CHECK_EQUAL(result.out, "a b;c $HOME\n");
+
+  result = script.get();
+  BOOST_CHECK(!result.succeeded());
+  BOOST_CHECK_EQUAL(result.status, 3);
+  BOOST_CHECK_EQUAL(result.signal, 0);
+  BOOST_CHECK_EQUAL(result.out, "out\n");
+  BOOST_CHECK_EQUAL(result.err, "err\n");
+  BOOST_CHECK_EQUAL(result.describe(), "exit status 3");
+
+  BOOST_CHECK_EQUAL(large.get().out.size(), 1000000u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( concurrency_test ) {
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::future<ProcessExecutor::Result>> results;
+  {
+    ProcessExecutor executor(4);
+    for (int i = 0; i < 4; ++i) {
+      results.push_back(executor.submit({"sleep", "0.5"}));
+    }
+    results.push_back(executor.submit({"sh", "-c", "kill -9 $$"}));
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  // four children at once, then the fifth one
+  BOOST_CHECK(elapsed < std::chrono::milliseconds(1800));
+  for (int i = 0; i < 4; ++i) {
+    BOOST_CHECK(results[i].get().succeeded());
+  }
+  ProcessExecutor::Result killed = results[4].get();
+  BOOST_CHECK_EQUAL(killed.status, -1);
+  BOOST_CHECK_EQUAL(killed.signal, 9);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( timeout_test ) {
+
+  ProcessExecutor executor(2);
+  auto start = std::chrono::steady_clock::now();
+  auto slow = executor.submit({"sleep", "30"}, std::chrono::milliseconds(200));
+  auto fast = executor.submit({"true"}, std::chrono::milliseconds(10000));
+
+  BOOST_CHECK(fast.get().succeeded());
+  ProcessExecutor::Result result = slow.get();
+  BOOST_CHECK(result.timedOut);
+  BOOST_CHECK(!result.succeeded());
+  BOOST_CHECK(std::chrono::steady_clock::now() - start < std::chrono::seconds(10));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( timeout_group_test ) {
+
+  // the shell starts a descendant in the background and waits for it
+  ProcessExecutor executor(1);
+  auto script = executor.submit({"sh", "-c", "sleep 30 & echo $!; wait"}, std::chrono::milliseconds(200));
+  ProcessExecutor::Result result = script.get();
+  BOOST_CHECK(result.timedOut);
+  pid_t descendant = static_cast<pid_t>(std::stol(result.out));
+
+  // the descendant is killed with the shell, it is gone or a zombie until it is reaped
+  bool alive = true;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (alive && std::chrono::steady_clock::now() < deadline) {
+    std::ifstream stat("/proc/" + std::to_string(descendant) + "/stat");
+    std::string pid, command, state;
+    alive = static_cast<bool>(stat >> pid >> command >> state) && state != "Z";
+    if (alive) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  BOOST_CHECK(!alive);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( spawn_error_test ) {
+
+  ProcessExecutor executor(1);
+  auto missing = executor.submit({"DmModule_no_such_program"});
+  BOOST_CHECK_THROW(missing.get(), Elements::Exception);
+  BOOST_CHECK_THROW(executor.submit({}), Elements::Exception);
+  BOOST_CHECK(executor.submit({"true"}).get().succeeded());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
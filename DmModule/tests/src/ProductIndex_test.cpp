@@ -0,0 +1,208 @@
+/**
+ * @file tests/src/ProductIndex_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+#include <fstream>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/DmOutput.h"
+#include "DmModule/ProductIndex.h"
+
+namespace fs = boost::filesystem;
+using DmModule::ProductIndex;
+
+namespace {
+
+void writeFile(const fs::path& filename, const std::string& content) {
+  std::ofstream out(filename.string(), std::ios::trunc);
+  out << content;
+}
+
+struct Workdir {
+  Workdir(): path(fs::temp_directory_path() / fs::unique_path("ProductIndex_test_%%%%%%")) {
+    fs::create_directories(path / "data");
+  }
+  ~Workdir() { fs::remove_all(path); }
+  fs::path path;
+};
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (ProductIndex_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( parse_test ) {
+
+  ProductIndex::Product product;
+  ProductIndex::parseProduct("<?xml version=\"1.0\"?>\n<!-- <NotTheRoot> -->\n"
+                             "<twodmass:DpdTwoDMassLensMCCatalog xmlns:twodmass=\"x\">"
+                             "<Data><DataContainer><FileName>cat&amp;1.fits</FileName></DataContainer>"
+                             "<DataContainer><FileName> </FileName></DataContainer></Data>"
+                             "</twodmass:DpdTwoDMassLensMCCatalog>", product);
+  BOOST_CHECK_EQUAL(product.type, "DpdTwoDMassLensMCCatalog");
+  BOOST_REQUIRE_EQUAL(product.dataFiles.size(), 2u);
+  BOOST_CHECK_EQUAL(product.dataFiles[0].name, "cat&1.fits");
+
+  // FileName elements with a namespace prefix or attributes, other elements and comments are ignored
+  ProductIndex::parseProduct("<DpdTwoDMassConvergencePatch><Data>"
+                             "<FileNameList>list.txt</FileNameList><OtherFileName>other.fits</OtherFileName>"
+                             "<!-- <FileName>commented.fits</FileName> -->"
+                             "<sys:FileName xmlns:sys=\"y\">a.fits</sys:FileName>"
+                             "<FileName\n  filestatus=\"PROPOSED\">b.fits</FileName><FileName/>"
+                             "</Data></DpdTwoDMassConvergencePatch>", product);
+  BOOST_CHECK_EQUAL(product.type, "DpdTwoDMassConvergencePatch");
+  BOOST_REQUIRE_EQUAL(product.dataFiles.size(), 2u);
+  BOOST_CHECK_EQUAL(product.dataFiles[0].name, "a.fits");
+  BOOST_CHECK_EQUAL(product.dataFiles[1].name, "b.fits");
+
+  ProductIndex::parseProduct("not a product", product);
+  BOOST_CHECK(product.type.empty());
+  BOOST_CHECK(product.dataFiles.empty());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( update_test ) {
+
+  Workdir workdir;
+  for (int i = 0; i < 600; ++i) {
+    DmModule::DmOutput::createOutputXml(workdir.path / ("Product_" + std::to_string(i) + ".xml"),
+                                        "Map_" + std::to_string(i % 3) + ".fits");
+  }
+  writeFile(workdir.path / "data" / "Map_0.fits", "0123456789");
+  writeFile(workdir.path / "notes.txt", "not indexed");
+
+  ProductIndex index(workdir.path);
+  BOOST_CHECK_EQUAL(index.size(), 0u);
+  BOOST_CHECK_EQUAL(index.update(4), 600u);
+  BOOST_CHECK_EQUAL(index.size(), 600u);
+
+  const ProductIndex::Product& product = index.resolve("Product_3.xml", "DpdTwoDMassConvergencePatch");
+  BOOST_REQUIRE_EQUAL(product.dataFiles.size(), 1u);
+  BOOST_CHECK_EQUAL(product.dataFiles[0].name, "Map_0.fits");
+  BOOST_CHECK(product.dataFiles[0].exists);
+  BOOST_CHECK_EQUAL(product.dataFiles[0].size, 10u);
+  BOOST_CHECK(!index.resolve("Product_4.xml").dataFiles[0].exists);
+  BOOST_CHECK(index.find("notes.txt") == nullptr);
+  BOOST_CHECK_THROW(index.resolve("Missing.xml"), Elements::Exception);
+  BOOST_CHECK_THROW(index.resolve("Product_3.xml", "DpdTwoDMassLensMCCatalog"), Elements::Exception);
+
+  BOOST_CHECK_EQUAL(index.findByType("DpdTwoDMassConvergencePatch").size(), 600u);
+  auto products = index.findByDataFile("Map_1.fits");
+  BOOST_REQUIRE_EQUAL(products.size(), 200u);
+  BOOST_CHECK_EQUAL(products[0]->file, "Product_1.xml");
+
+  // Incremental update: only the new and modified products are parsed
+  BOOST_CHECK_EQUAL(index.update(4), 0u);
+  DmModule::DmOutput::createOutputXml(workdir.path / "Product_1.xml", "Other.fits");
+  DmModule::DmOutput::createOutputXml(workdir.path / "Product_600.xml", "Map_1.fits");
+  fs::remove(workdir.path / "Product_2.xml");
+  writeFile(workdir.path / "data" / "Map_1.fits", "01234");
+  BOOST_CHECK_EQUAL(index.update(4), 2u);
+  BOOST_CHECK_EQUAL(index.size(), 600u);
+  BOOST_CHECK(index.find("Product_2.xml") == nullptr);
+  BOOST_CHECK_EQUAL(index.resolve("Product_1.xml").dataFiles[0].name, "Other.fits");
+  BOOST_CHECK_EQUAL(index.resolve("Product_4.xml").dataFiles[0].size, 5u);
+  BOOST_CHECK_EQUAL(index.findByDataFile("Map_1.fits").size(), 200u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( save_test ) {
+
+  Workdir workdir;
+  DmModule::DmOutput::createOutputXml(workdir.path / "A.xml", "A.fits");
+  DmModule::DmOutput::createOutputXml(workdir.path / "B.xml", "B.fits");
+  writeFile(workdir.path / "data" / "A.fits", "abc");
+
+  ProductIndex index(workdir.path);
+  index.update(2);
+  index.save();
+  BOOST_CHECK(fs::exists(workdir.path / ".DmProductIndex"));
+
+  // the saved index is up to date, nothing is parsed again
+  ProductIndex loaded(workdir.path);
+  BOOST_REQUIRE_EQUAL(loaded.size(), 2u);
+  const ProductIndex::Product& product = loaded.resolve("A.xml");
+  BOOST_CHECK_EQUAL(product.type, "DpdTwoDMassConvergencePatch");
+  BOOST_CHECK_EQUAL(product.size, index.resolve("A.xml").size);
+  BOOST_CHECK_EQUAL(product.mtime, index.resolve("A.xml").mtime);
+  BOOST_REQUIRE_EQUAL(product.dataFiles.size(), 1u);
+  BOOST_CHECK(product.dataFiles[0].exists);
+  BOOST_CHECK_EQUAL(product.dataFiles[0].size, 3u);
+  BOOST_CHECK_EQUAL(loaded.update(2), 0u);
+
+  // a corrupted index is ignored
+  writeFile(workdir.path / ".DmProductIndex", "DMIDX001\x05");
+  ProductIndex truncated(workdir.path);
+  BOOST_CHECK_EQUAL(truncated.size(), 0u);
+  writeFile(workdir.path / ".DmProductIndex", "garbage");
+  ProductIndex unknown(workdir.path);
+  BOOST_CHECK_EQUAL(unknown.size(), 0u);
+  BOOST_CHECK_EQUAL(unknown.update(2), 2u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( refresh_test ) {
+
+  Workdir workdir;
+  DmModule::DmOutput::createOutputXml(workdir.path / "A.xml", "A.fits");
+  DmModule::DmOutput::createOutputXml(workdir.path / "B.xml", "B.fits");
+
+  ProductIndex index(workdir.path);
+  BOOST_CHECK(index.isStale());
+  index.update(2);
+  index.save();
+  BOOST_CHECK(!ProductIndex(workdir.path).isStale());
+
+  // single products are refreshed without a scan
+  DmModule::DmOutput::createOutputXml(workdir.path / "A.xml", "Other.fits");
+  writeFile(workdir.path / "data" / "Other.fits", "abc");
+  BOOST_CHECK(index.refresh("A.xml"));
+  BOOST_CHECK(!index.refresh("B.xml"));
+  BOOST_CHECK_EQUAL(index.resolve("A.xml").dataFiles[0].name, "Other.fits");
+  BOOST_CHECK(index.resolve("A.xml").dataFiles[0].exists);
+  DmModule::DmOutput::createOutputXml(workdir.path / "C.xml", "C.fits");
+  BOOST_CHECK(index.refresh("C.xml"));
+  BOOST_CHECK_EQUAL(index.size(), 3u);
+  fs::remove(workdir.path / "B.xml");
+  BOOST_CHECK(!index.refresh("B.xml"));
+  BOOST_CHECK(index.find("B.xml") == nullptr);
+  index.save();
+  BOOST_CHECK(!ProductIndex(workdir.path).isStale());
+
+  // a product added by someone else makes the saved index stale
+  writeFile(workdir.path / "D.xml", "<DpdTwoDMassConvergencePatch/>");
+  ProductIndex loaded(workdir.path);
+  BOOST_CHECK_EQUAL(loaded.size(), 2u);
+  BOOST_CHECK(loaded.isStale());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
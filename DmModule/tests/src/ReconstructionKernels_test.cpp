@@ -0,0 +1,129 @@
+/**
+ * @file tests/src/ReconstructionKernels_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "DmModule/ReconstructionKernels.h"
+
+using namespace DmModule;
+
+namespace {
+
+double variance(const std::vector<double>& scale, const std::vector<char>& mask, char selected) {
+  double sum = 0., sumSq = 0.;
+  std::size_t n = 0;
+  for (std::size_t k = 0; k < scale.size(); ++k) {
+    if (mask[k] == selected) {
+      sum += scale[k];
+      sumSq += scale[k] * scale[k];
+      ++n;
+    }
+  }
+  return sumSq / n - (sum / n) * (sum / n);
+}
+
+}  // namespace
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (ReconstructionKernels_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( threshold_test ) {
+  std::vector<double> scale {0.1, -2., 0.5, 3., -0.2, 1.5};
+  std::vector<char> mask {1, 1, 1, 0, 0, 0};
+  Kernels::thresholdScale<false>(scale.data(), mask.data(), scale.size(), 1.);
+  std::vector<double> expected {0., -2., 0., 3., 0., 1.5};
+  BOOST_CHECK_EQUAL_COLLECTIONS(scale.begin(), scale.end(), expected.begin(), expected.end());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( equal_variance_test ) {
+  std::vector<double> scale {1., -1., 2., -2., 0.5, -0.5, 0.25, -0.25};
+  std::vector<char> mask {1, 1, 1, 1, 0, 0, 0, 0};
+  Kernels::thresholdScale<true>(scale.data(), mask.data(), scale.size(), 0.);
+  BOOST_CHECK_CLOSE(variance(scale, mask, 0), variance(scale, mask, 1), 1e-9);
+  BOOST_CHECK_EQUAL(scale[0], 1.);
+  BOOST_CHECK_EQUAL(scale[3], -2.);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( bmodes_test ) {
+  std::vector<double> kappaB {1., 2., 3.};
+  std::vector<char> mask {1, 0, 1};
+  Kernels::constrainBModes<false>(kappaB.data(), mask.data(), kappaB.size());
+  BOOST_CHECK_EQUAL(kappaB[1], 2.);
+  Kernels::constrainBModes<true>(kappaB.data(), mask.data(), kappaB.size());
+  BOOST_CHECK_EQUAL(kappaB[0], 1.);
+  BOOST_CHECK_EQUAL(kappaB[1], 0.);
+  BOOST_CHECK_EQUAL(kappaB[2], 3.);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( grid_roundtrip_test ) {
+  std::size_t xdim = 4, ydim = 2;
+  std::vector<double> in1(xdim * ydim), in2(xdim * ydim);
+  for (std::size_t k = 0; k < in1.size(); ++k) {
+    in1[k] = k;
+    in2[k] = -1. * k;
+  }
+
+  std::vector<double> buffer(2 * 4 * xdim * ydim, 0.), out1(in1.size()), out2(in2.size());
+  Kernels::packGrid<true>(in1.data(), in2.data(), buffer.data(), xdim, ydim, 2 * xdim, xdim / 2, ydim / 2);
+  // pixel (1, 1) of the map at (3, 2) in the padded buffer
+  BOOST_CHECK_EQUAL(buffer[2 * (2 * 2 * xdim + 3)], in1[1 * xdim + 1]);
+  Kernels::unpackGrid<true>(buffer.data(), 2., out1.data(), out2.data(), xdim, ydim, 2 * xdim, xdim / 2, ydim / 2);
+  for (std::size_t k = 0; k < in1.size(); ++k) {
+    BOOST_CHECK_EQUAL(out1[k], 2. * in1[k]);
+    BOOST_CHECK_EQUAL(out2[k], 2. * in2[k]);
+  }
+
+  Kernels::packGrid<false>(in1.data(), in2.data(), buffer.data(), xdim, ydim, xdim, 0, 0);
+  BOOST_CHECK_EQUAL(buffer[2 * 5 + 1], in2[5]);
+  Kernels::unpackGrid<false>(buffer.data(), 1., out1.data(), out2.data(), xdim, ydim, xdim, 0, 0);
+  BOOST_CHECK_EQUAL_COLLECTIONS(out1.begin(), out1.end(), in1.begin(), in1.end());
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( redshift_bin_test ) {
+  std::vector<double> zEdges {0.2, 0.5, 1.};
+  std::vector<int> balanced {1, -1, 0};
+  BOOST_CHECK_EQUAL(Kernels::redshiftBin<false>(0, 0.1, balanced, zEdges), -1);
+  BOOST_CHECK_EQUAL(Kernels::redshiftBin<false>(0, 0.3, balanced, zEdges), 0);
+  BOOST_CHECK_EQUAL(Kernels::redshiftBin<false>(0, 0.5, balanced, zEdges), 1);
+  BOOST_CHECK_EQUAL(Kernels::redshiftBin<false>(0, 1., balanced, zEdges), -1);
+  BOOST_CHECK_EQUAL(Kernels::redshiftBin<true>(0, 0.1, balanced, zEdges), 1);
+  BOOST_CHECK_EQUAL(Kernels::redshiftBin<true>(1, 0.3, balanced, zEdges), -1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
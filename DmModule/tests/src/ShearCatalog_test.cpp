@@ -0,0 +1,84 @@
+/**
+ * @file tests/src/ShearCatalog_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fitsio.h>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/ShearCatalog.h"
+
+namespace fs = boost::filesystem;
+using DmModule::ShearCatalog;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (ShearCatalog_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( columns_length_test ) {
+
+  BOOST_CHECK_THROW(ShearCatalog({1., 2.}, {1., 2.}, {0., 0.}, {0., 0.}, {1.}, {0.5, 0.5}), Elements::Exception);
+  ShearCatalog catalog({1., 2.}, {1., 2.}, {0., 0.}, {0., 0.}, {1., 1.}, {0.5, 0.5});
+  BOOST_CHECK_EQUAL(catalog.getNbGalaxies(), 2u);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( read_fits_test ) {
+
+  fs::path filename = fs::temp_directory_path() / fs::unique_path("ShearCatalog_test_%%%%%%.fits");
+  std::vector<double> ra {10., 10.5, 11.}, dec {-5., -5.5, -6.}, g1 {0.01, 0.02, 0.03}, g2 {-0.01, 0., 0.01};
+  std::vector<double> z {0.5, 1., 1.5};
+
+  // catalog without weight column
+  const char* ttype[] = {"RA", "DEC", "G1", "G2", "Z"};
+  const char* tform[] = {"D", "D", "D", "D", "D"};
+  fitsfile* fptr = nullptr;
+  int status = 0;
+  fits_create_file(&fptr, filename.string().c_str(), &status);
+  fits_create_tbl(fptr, BINARY_TBL, 3, 5, const_cast<char**>(ttype), const_cast<char**>(tform), nullptr,
+                  "CATALOG", &status);
+  fits_write_col(fptr, TDOUBLE, 1, 1, 1, 3, ra.data(), &status);
+  fits_write_col(fptr, TDOUBLE, 2, 1, 1, 3, dec.data(), &status);
+  fits_write_col(fptr, TDOUBLE, 3, 1, 1, 3, g1.data(), &status);
+  fits_write_col(fptr, TDOUBLE, 4, 1, 1, 3, g2.data(), &status);
+  fits_write_col(fptr, TDOUBLE, 5, 1, 1, 3, z.data(), &status);
+  fits_close_file(fptr, &status);
+  BOOST_REQUIRE_EQUAL(status, 0);
+
+  ShearCatalog catalog = ShearCatalog::readFits(filename);
+  BOOST_CHECK_EQUAL(catalog.getNbGalaxies(), 3u);
+  BOOST_CHECK_EQUAL(catalog.getDec()[1], -5.5);
+  BOOST_CHECK_EQUAL(catalog.getGamma1()[2], 0.03);
+  BOOST_CHECK_EQUAL(catalog.getZ()[0], 0.5);
+  BOOST_CHECK_EQUAL(catalog.getWeight()[1], 1.);
+  fs::remove(filename);
+
+  BOOST_CHECK_THROW(ShearCatalog::readFits(filename), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
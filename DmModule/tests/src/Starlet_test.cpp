@@ -0,0 +1,83 @@
+/**
+ * @file tests/src/Starlet_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include "DmModule/Starlet.h"
+
+using DmModule::Starlet;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (Starlet_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( nb_scales_test ) {
+
+  BOOST_CHECK_EQUAL(Starlet(64, 64).getNbScales(), 4);
+  BOOST_CHECK_EQUAL(Starlet(1024, 512).getNbScales(), 7);
+  BOOST_CHECK_EQUAL(Starlet(4, 4).getNbScales(), 2);
+  BOOST_CHECK_EQUAL(Starlet(64, 64, 3).getNbScales(), 3);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( reconstruction_test ) {
+
+  const std::size_t xdim = 20, ydim = 16;
+  std::vector<double> image(xdim * ydim), coefficients, output(xdim * ydim);
+  for (std::size_t k = 0; k < image.size(); ++k) {
+    image[k] = std::sin(0.3 * k) + (k % 7 == 0 ? 2. : 0.);
+  }
+
+  Starlet starlet(xdim, ydim, 4);
+  starlet.transform(image.data(), coefficients);
+  BOOST_CHECK_EQUAL(coefficients.size(), 4 * xdim * ydim);
+
+  starlet.reconstruct(coefficients, output.data());
+  for (std::size_t k = 0; k < image.size(); ++k) {
+    BOOST_CHECK_SMALL(output[k] - image[k], 1e-12);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( constant_image_test ) {
+
+  // a constant image has no wavelet coefficient, everything is in the smooth approximation
+  std::vector<double> image(16 * 16, 3.), coefficients;
+  Starlet starlet(16, 16, 3);
+  starlet.transform(image.data(), coefficients);
+  for (std::size_t k = 0; k < 2 * image.size(); ++k) {
+    BOOST_CHECK_SMALL(coefficients[k], 1e-12);
+  }
+  BOOST_CHECK_CLOSE(coefficients[2 * image.size()], 3., 1e-9);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
@@ -0,0 +1,126 @@
+/**
+ * @file tests/src/Topology_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+#include <boost/test/unit_test.hpp>
+
+#include <sched.h>
+
+#include <boost/filesystem/fstream.hpp>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/Topology.h"
+
+namespace fs = boost::filesystem;
+using DmModule::Topology;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (Topology_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( cpu_list_test ) {
+
+  BOOST_CHECK(Topology::parseCpuList("").empty());
+  BOOST_CHECK(Topology::parseCpuList("0-3,8,10-11\n") == std::vector<int>({0, 1, 2, 3, 8, 10, 11}));
+  BOOST_CHECK(Topology::parseCpuList("5,1-2,2") == std::vector<int>({1, 2, 5}));
+  BOOST_CHECK_THROW(Topology::parseCpuList("0-a"), Elements::Exception);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( detect_test ) {
+
+  // two nodes, the second one without CPU
+  fs::path sysfs = fs::temp_directory_path() / fs::unique_path("Topology_test_%%%%%%");
+  fs::create_directories(sysfs / "node0");
+  fs::create_directories(sysfs / "node1");
+  fs::ofstream(sysfs / "node0" / "cpulist") << "0-1023\n";
+  fs::ofstream(sysfs / "node1" / "cpulist") << "\n";
+
+  Topology topology = Topology::detect(sysfs);
+  BOOST_REQUIRE_EQUAL(topology.getNbNodes(), 1u);
+  // restricted to the CPUs available to the process
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(set), &set), 0);
+  BOOST_CHECK_EQUAL(topology.getCpus(0).size(), static_cast<std::size_t>(CPU_COUNT(&set)));
+
+  // no NUMA information
+  Topology flat = Topology::detect(sysfs / "missing");
+  BOOST_CHECK_EQUAL(flat.getNbNodes(), 1u);
+  BOOST_CHECK(flat.getCpus(0) == topology.getCpus(0));
+
+  fs::remove_all(sysfs);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( node_id_test ) {
+
+  // node ids with holes, listed out of order, and entries which are not nodes
+  fs::path sysfs = fs::temp_directory_path() / fs::unique_path("Topology_test_%%%%%%");
+  for (const char* node : {"node0", "node2", "node10", "node5"}) {
+    fs::create_directories(sysfs / node);
+  }
+  fs::create_directories(sysfs / "nodex");
+  fs::create_directories(sysfs / "power");
+  fs::ofstream(sysfs / "online") << "0,2,5,10\n";
+  fs::ofstream(sysfs / "node0" / "cpulist") << "\n";
+  fs::ofstream(sysfs / "node2" / "cpulist") << "0-1023\n";
+  fs::ofstream(sysfs / "node5" / "cpulist") << "0-1023\n";
+  fs::ofstream(sysfs / "node10" / "cpulist") << "0-1023\n";
+  fs::ofstream(sysfs / "nodex" / "cpulist") << "0-1023\n";
+
+  // node0 has no CPU and is dropped, the others keep their ids
+  Topology topology = Topology::detect(sysfs);
+  BOOST_REQUIRE_EQUAL(topology.getNbNodes(), 3u);
+  BOOST_CHECK_EQUAL(topology.getNodeId(0), 2);
+  BOOST_CHECK_EQUAL(topology.getNodeId(1), 5);
+  BOOST_CHECK_EQUAL(topology.getNodeId(2), 10);
+  BOOST_CHECK(!topology.getCpus(2).empty());
+
+  BOOST_CHECK_EQUAL(Topology({{0}, {}, {1}}).getNodeId(1), 2);
+  BOOST_CHECK_EQUAL(Topology::detect(sysfs / "missing").getNodeId(0), 0);
+
+  fs::remove_all(sysfs);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( pin_test ) {
+
+  Topology topology = Topology::detect();
+  std::vector<int> cpu {topology.getCpus(0).front()};
+  BOOST_CHECK(Topology::pinCurrentThread(cpu));
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  BOOST_REQUIRE_EQUAL(sched_getaffinity(0, sizeof(set), &set), 0);
+  BOOST_CHECK_EQUAL(CPU_COUNT(&set), 1);
+  BOOST_CHECK(CPU_ISSET(cpu[0], &set));
+  BOOST_CHECK(!Topology::pinCurrentThread({}));
+  BOOST_CHECK(Topology::pinCurrentThread(topology.getCpus(0)));
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()
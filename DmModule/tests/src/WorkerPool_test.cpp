@@ -0,0 +1,120 @@
+/**
+ * @file tests/src/WorkerPool_test.cpp
+ * @date 10/19/26
+ * @author user
+ *
+ * @copyright (C) 2012-2020 Euclid Science Ground Segment
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the Free
+ * Software Foundation; either version 3.0 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public License for more
+ * details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <sched.h>
+
+#include "ElementsKernel/Exception.h"
+#include "DmModule/WorkerPool.h"
+
+using DmModule::Topology;
+using DmModule::WorkerPool;
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE (WorkerPool_test)
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( results_test ) {
+
+  WorkerPool pool(4);
+  BOOST_CHECK_EQUAL(pool.getNbWorkers(), 4u);
+
+  std::vector<std::future<int>> results;
+  for (int i = 0; i < 100; ++i) {
+    results.push_back(pool.submit([i]() { return i * i; }));
+  }
+  for (int i = 0; i < 100; ++i) {
+    BOOST_CHECK_EQUAL(results[i].get(), i * i);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( drain_on_destruction_test ) {
+
+  std::atomic<int> count(0);
+  {
+    WorkerPool pool(2);
+    for (int i = 0; i < 50; ++i) {
+      pool.submit([&count]() { ++count; });
+    }
+  }
+  BOOST_CHECK_EQUAL(count.load(), 50);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( exception_test ) {
+
+  WorkerPool pool(1);
+  auto result = pool.submit([]() -> int { throw std::runtime_error("failed"); });
+  BOOST_CHECK_THROW(result.get(), std::runtime_error);
+  BOOST_CHECK_EQUAL(pool.submit([]() { return 1; }).get(), 1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_CASE( placement_test ) {
+
+  BOOST_CHECK(WorkerPool::parsePlacement("socket") == WorkerPool::Placement::SOCKET);
+  BOOST_CHECK_THROW(WorkerPool::parsePlacement("numa"), Elements::Exception);
+  BOOST_CHECK_EQUAL(WorkerPool::getCurrentNode(), -1);
+
+  // two nodes sharing the CPU of the process
+  std::vector<int> cpus = Topology::detect().getCpus(0);
+  Topology topology({{cpus.front()}, {cpus.back()}});
+  WorkerPool pool(4, WorkerPool::Placement::CORE, topology);
+  BOOST_CHECK_EQUAL(pool.getNbNodes(), 2u);
+
+  std::vector<std::future<std::pair<int, int>>> results;
+  for (unsigned i = 0; i < 20; ++i) {
+    results.push_back(pool.submitOn(i, [i]() {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      sched_getaffinity(0, sizeof(set), &set);
+      return std::make_pair(WorkerPool::getCurrentNode(), CPU_COUNT(&set));
+    }));
+  }
+  for (unsigned i = 0; i < 20; ++i) {
+    auto placed = results[i].get();
+    BOOST_CHECK_EQUAL(placed.first, static_cast<int>(i % 2));
+    BOOST_CHECK_EQUAL(placed.second, 1);
+  }
+  // tasks without a node run on any worker
+  BOOST_CHECK_GE(pool.submit([]() { return WorkerPool::getCurrentNode(); }).get(), 0);
+
+  // without placement the node is ignored
+  WorkerPool flat(2);
+  BOOST_CHECK_EQUAL(flat.getNbNodes(), 1u);
+  BOOST_CHECK_EQUAL(flat.submitOn(1, []() { return WorkerPool::getCurrentNode(); }).get(), -1);
+}
+
+//-----------------------------------------------------------------------------
+
+BOOST_AUTO_TEST_SUITE_END ()